@@ -4,30 +4,123 @@ Infrastructure Automation Tool - Main Entry Point
 
 This module provides the command-line interface for the infrastructure automation tool,
 handling inventory generation, server provisioning, and configuration management.
+
+Only modules without third-party dependencies are imported at startup. Cloud
+provider modules (and with them boto3 and botocore) are imported by the
+handler of the command that needs them, and logging is configured once the
+arguments are parsed, so --help and the Ansible commands start quickly.
 """
 
 import argparse
 import logging
 import os
 import sys
-from pathlib import Path
-from typing import Optional
-from python.src.inventory.aws_inventory import generate_aws_inventory
-from python.src.utils.ssh_manager import setup_ssh_key
-from python.src.utils.logging_config import setup_logging
-
-# Configure logging
-logging.basicConfig(
-    level=logging.INFO,
-    format='%(asctime)s - %(name)s - %(levelname)s - %(message)s',
-    handlers=[
-        logging.StreamHandler(sys.stdout),
-        logging.FileHandler('infra_automation.log')
-    ]
+import time
+from typing import Dict, List, Optional
+from python.src.inventory.cache import DEFAULT_CACHE_DIR, InventoryCache
+from python.src.inventory.delta import load_delta_limit
+from python.src.inventory.grouping import INSTANCE_KEYS
+from python.src.inventory.options import DEFAULT_REGION_WORKERS, INSTANCE_STATES
+from python.src.utils.ansible_config import (
+    DEFAULT_CONTROL_PERSIST,
+    DEFAULT_FACT_CACHE_DIR,
+    DEFAULT_FACT_CACHE_TIMEOUT,
+    AnsibleConfig,
+    clear_cached_facts
+)
+from python.src.utils.logging_config import LOG_FORMATS, setup_logging
+from python.src.utils.playbook_runner import (
+    DEFAULT_PLAYBOOK_WORKERS,
+    STRATEGIES,
+    ExecutionOptions,
+    check_pipelining,
+    count_inventory_hosts,
+    pair_runs,
+    parse_extra_vars,
+    parse_serial,
+    playbook_host_groups,
+    run_playbooks
 )
+from python.src.utils.exceptions import ConfigurationError, PlaybookError, ValidationError
+from python.src.utils.metrics import EXPORT_FORMATS, export_metrics_at_exit
+
+# Levels accepted by --log-level
+LOG_LEVELS = ('DEBUG', 'INFO', 'WARNING', 'ERROR')
+# Arguments of the tuned Ansible settings, which --ansible-config replaces
+ANSIBLE_TUNING_ARGUMENTS = {
+    'no_pipelining': '--no-pipelining',
+    'control_persist': '--control-persist',
+    'fact_cache_dir': '--fact-cache-dir',
+    'fact_cache_ttl': '--fact-cache-ttl',
+    'no_fact_cache': '--no-fact-cache',
+}
 
 logger = logging.getLogger(__name__)
 
+def serial_argument(value: str) -> List:
+    """Parse a --serial value, reporting errors as argparse usage errors."""
+    try:
+        return parse_serial(value)
+    except ValidationError as e:
+        raise argparse.ArgumentTypeError(str(e)) from e
+
+def positive_int(value: str) -> int:
+    """Parse an argument that must be a whole number of at least 1."""
+    try:
+        number = int(value)
+    except ValueError:
+        number = 0
+    if number < 1:
+        raise argparse.ArgumentTypeError(f"must be a whole number of at least 1: {value}")
+    return number
+
+def add_ansible_config_arguments(parser: argparse.ArgumentParser) -> None:
+    """Add the arguments that select the Ansible configuration."""
+    parser.add_argument('--ansible-config', metavar='PATH',
+                        help='Use only this ansible.cfg, without the tuned connection and '
+                             'fact cache settings')
+    parser.add_argument('--no-pipelining', action='store_true',
+                        help='Disable SSH pipelining, for hosts whose sudoers requires a tty')
+    parser.add_argument('--control-persist', type=int,
+                        help='Seconds idle SSH master connections are kept open '
+                             f'(default: {DEFAULT_CONTROL_PERSIST})')
+    parser.add_argument('--fact-cache-dir', metavar='PATH',
+                        help='Directory where gathered facts are cached between runs '
+                             f'(default: {DEFAULT_FACT_CACHE_DIR})')
+    parser.add_argument('--fact-cache-ttl', type=int, metavar='SECONDS',
+                        help='Seconds cached facts are used before they are gathered again '
+                             f'(default: {DEFAULT_FACT_CACHE_TIMEOUT})')
+    parser.add_argument('--no-fact-cache', action='store_true',
+                        help='Gather facts on every run instead of caching them')
+
+def add_playbook_arguments(parser: argparse.ArgumentParser) -> None:
+    """Add the arguments of the commands that run playbooks."""
+    add_ansible_config_arguments(parser)
+    parser.add_argument('--playbook', required=True, action='append',
+                        help='Path to the Ansible playbook, may be repeated')
+    parser.add_argument('--inventory', required=True, action='append',
+                        help='Path to the inventory file, may be repeated; a single '
+                             'playbook runs against every inventory, otherwise playbooks '
+                             'and inventories are paired in order')
+    parser.add_argument('--extra-vars', nargs='+',
+                        help='Extra variables for Ansible as KEY=VALUE or a JSON object')
+    parser.add_argument('--max-parallel', type=int, default=DEFAULT_PLAYBOOK_WORKERS,
+                        help='Maximum number of playbook runs at the same time')
+    parser.add_argument('--strategy', choices=STRATEGIES,
+                        help='Ansible execution strategy (default: linear)')
+    parser.add_argument('--forks', type=positive_int,
+                        help='Hosts each run works on in parallel (default: the number of '
+                             'hosts, between 5 and 50)')
+    parser.add_argument('--serial', type=serial_argument, metavar='BATCH[,BATCH...]',
+                        help='Roll out in batches of host counts or percentages, e.g. '
+                             '1,10%%,100%% (default: 5%%,100%% for more than 100 hosts)')
+    parser.add_argument('--throttle', type=positive_int,
+                        help='Maximum number of hosts running package tasks at the same time')
+    parser.add_argument('--gather-subset', type=lambda value: value.split(','),
+                        metavar='SUBSET[,SUBSET...]',
+                        help='Fact subsets gathered, e.g. all, also on hosts with cached '
+                             'facts (default: the subsets the playbook uses)')
+
 def setup_argparse() -> argparse.ArgumentParser:
     """Configure and return the argument parser for CLI."""
     parser = argparse.ArgumentParser(
@@ -35,6 +128,20 @@ def setup_argparse() -> argparse.ArgumentParser:
         formatter_class=argparse.RawDescriptionHelpFormatter
     )
     
+    parser.add_argument('--log-file', default='infra_automation.log',
+                        help='Log file path')
+    parser.add_argument('--log-level', choices=LOG_LEVELS, default='INFO',
+                        help='Lowest level logged')
+    parser.add_argument('--log-format', choices=LOG_FORMATS, default='text',
+                        help='Log file format; json writes one object per line')
+    parser.add_argument('--log-queue', action='store_true',
+                        help='Write log output on a background thread')
+    parser.add_argument('--metrics-file',
+                        help='Write operation timings to this file at exit, e.g. in the '
+                             'node_exporter textfile collector directory')
+    parser.add_argument('--metrics-format', choices=EXPORT_FORMATS, default='prometheus',
+                        help='Format of the metrics file')
+    
     subparsers = parser.add_subparsers(dest='command', help='Available commands')
     
     # Inventory command
@@ -42,27 +149,54 @@ def setup_argparse() -> argparse.ArgumentParser:
     inventory_parser.add_argument('--provider', required=True, choices=['aws', 'gcp', 'azure'],
                                 help='Cloud provider')
     inventory_parser.add_argument('--region', required=True,
-                                help='Region for inventory generation')
+                                help='Region for inventory generation, a comma-separated '
+                                     'list of regions, or "all" for every enabled region')
+    inventory_parser.add_argument('--max-workers', type=int, default=DEFAULT_REGION_WORKERS,
+                                help='Maximum number of regions queried concurrently')
+    inventory_parser.add_argument('--state', action='append', choices=INSTANCE_STATES,
+                                help='Instance state to include, may be repeated (default: running)')
+    inventory_parser.add_argument('--tag', action='append', metavar='KEY=VALUE[,VALUE]',
+                                help='Only include instances with a matching tag, may be repeated')
+    inventory_parser.add_argument('--cache-dir', default=DEFAULT_CACHE_DIR,
+                                help='Directory for cached instance listings')
+    inventory_parser.add_argument('--max-age', type=float, default=0,
+                                help='Serve listings cached up to this many seconds ago instead of '
+                                     'calling the API (default: 0, no cache)')
+    inventory_parser.add_argument('--refresh', action='store_true',
+                                help='Ignore cached listings and refresh them from the API')
+    inventory_parser.add_argument('--delta', action='store_true',
+                                help='Also write the hosts added, removed or changed since the '
+                                     'previous inventory to <output>.delta.json')
+    inventory_parser.add_argument('--compact', action='store_true',
+                                help='Write compact JSON instead of indented JSON')
+    inventory_parser.add_argument('--group-by', action='append', metavar='KEY[=PREFIX]',
+                                help='Also group hosts by tag:<key> or one of '
+                                     f'{", ".join(INSTANCE_KEYS)}, may be repeated')
     inventory_parser.add_argument('--output', default='inventories/inventory.yml',
                                 help='Output inventory file path')
     
     # Provision command
     provision_parser = subparsers.add_parser('provision', help='Provision servers')
-    provision_parser.add_argument('--playbook', required=True,
-                                help='Path to the Ansible playbook')
-    provision_parser.add_argument('--inventory', required=True,
-                                help='Path to the inventory file')
-    provision_parser.add_argument('--extra-vars', nargs='+',
-                                help='Extra variables for Ansible')
+    add_playbook_arguments(provision_parser)
     
     # Configure command
     configure_parser = subparsers.add_parser('configure', help='Configure servers')
-    configure_parser.add_argument('--playbook', required=True,
-                                help='Path to the Ansible playbook')
-    configure_parser.add_argument('--inventory', required=True,
-                                help='Path to the inventory file')
-    configure_parser.add_argument('--extra-vars', nargs='+',
-                                help='Extra variables for Ansible')
+    add_playbook_arguments(configure_parser)
+    configure_parser.add_argument('--changed-only', metavar='DELTA_FILE',
+                                help='Only configure hosts added or changed according to '
+                                     'an inventory delta file')
+    
+    # Pipelining check command
+    check_parser = subparsers.add_parser(
+        'check-pipelining', help='Verify that SSH pipelining works with sudo on every host'
+    )
+    check_parser.add_argument('--inventory', required=True,
+                            help='Path to the inventory file')
+    check_parser.add_argument('--limit', metavar='HOST[,HOST...]',
+                            help='Only check these hosts')
+    check_parser.add_argument('--forks', type=positive_int,
+                            help='Hosts checked in parallel')
+    add_ansible_config_arguments(check_parser)
     
     return parser
 
@@ -88,20 +222,165 @@ def validate_environment() -> None:
 def handle_inventory(args: argparse.Namespace) -> None:
     """Handle inventory generation command."""
     logger.info(f"Generating inventory for {args.provider} in {args.region}")
-    # TODO: Implement inventory generation logic
-    pass
+    
+    if args.provider != 'aws':
+        raise ConfigurationError(f"Inventory generation is not supported for {args.provider}")
+    
+    from python.src.inventory.aws_inventory import (
+        generate_aws_inventory,
+        generate_multi_region_inventory,
+        parse_tag_filters,
+        resolve_regions
+    )
+    
+    output_dir = os.path.dirname(args.output)
+    if output_dir:
+        os.makedirs(output_dir, exist_ok=True)
+    
+    cache = InventoryCache(args.cache_dir, args.max_age) if args.max_age > 0 else None
+    tags = parse_tag_filters(args.tag)
+    regions = resolve_regions(args.region)
+    if len(regions) == 1:
+        generate_aws_inventory(
+            regions[0],
+            args.output,
+            states=args.state,
+            tags=tags,
+            cache=cache,
+            refresh=args.refresh,
+            delta=args.delta,
+            compact=args.compact,
+            group_by=args.group_by
+        )
+    else:
+        generate_multi_region_inventory(
+            regions,
+            args.output,
+            max_workers=args.max_workers,
+            states=args.state,
+            tags=tags,
+            cache=cache,
+            refresh=args.refresh,
+            delta=args.delta,
+            compact=args.compact,
+            group_by=args.group_by
+        )
+
+def check_ansible_config_arguments(parser: argparse.ArgumentParser,
+                                   args: argparse.Namespace) -> None:
+    """Reject tuned Ansible settings combined with --ansible-config, which ignores them."""
+    if not getattr(args, 'ansible_config', None):
+        return
+    conflicting = [
+        flag for dest, flag in ANSIBLE_TUNING_ARGUMENTS.items()
+        if getattr(args, dest) not in (None, False)
+    ]
+    if conflicting:
+        parser.error(f"--ansible-config can't be combined with {', '.join(conflicting)}")
+
+def fact_cache_dir(args: argparse.Namespace) -> Optional[str]:
+    """Get the fact cache directory of a command, or None if facts aren't cached."""
+    if args.ansible_config or args.no_fact_cache:
+        return None
+    return args.fact_cache_dir or DEFAULT_FACT_CACHE_DIR
+
+def ansible_envvars(args: argparse.Namespace) -> Dict[str, str]:
+    """Get the environment with the Ansible settings of a command.
+    
+    The tuned settings are layered over the project or user ansible.cfg;
+    --ansible-config replaces them with the given configuration.
+    """
+    if args.ansible_config:
+        return {'ANSIBLE_CONFIG': os.path.abspath(args.ansible_config)}
+    config = AnsibleConfig(
+        pipelining=not args.no_pipelining,
+        control_persist=(DEFAULT_CONTROL_PERSIST if args.control_persist is None
+                         else args.control_persist),
+        fact_cache_dir=fact_cache_dir(args),
+        fact_cache_timeout=(DEFAULT_FACT_CACHE_TIMEOUT if args.fact_cache_ttl is None
+                            else args.fact_cache_ttl)
+    )
+    return config.prepare()
+
+def execute_playbooks(args: argparse.Namespace, limit: Optional[List[str]] = None) -> None:
+    """Run the playbook and inventory pairs of a command concurrently.
+    
+    Args:
+        args: Parsed arguments of a command that runs playbooks
+        limit: Hosts the runs are limited to
+    
+    Raises:
+        PlaybookError: If any run fails
+    """
+    runs = pair_runs(args.playbook, args.inventory, limit, parse_extra_vars(args.extra_vars))
+    execution = ExecutionOptions(args.strategy, args.forks, args.serial, args.throttle,
+                                 args.gather_subset)
+    for run in runs:
+        host_count = len(limit) if limit else count_inventory_hosts(
+            run.inventory, playbook_host_groups(run.playbook)
+        )
+        run.execution = execution.with_defaults(host_count)
+        logger.info(f"Running {run.label} on {host_count or 'unknown number of'} hosts: "
+                    f"{run.execution}")
+    
+    started = time.monotonic()
+    results = run_playbooks(runs, args.max_parallel, envvars=ansible_envvars(args))
+    elapsed = time.monotonic() - started
+    
+    for result in results:
+        batches = ", ".join(f"{timing.elapsed:.1f}s" for timing in result.batches)
+        logger.info(f"{result.run.label}: {result.status} in {result.elapsed:.1f} seconds"
+                    + (f" (batches: {batches})" if batches else ""))
+    
+    failed = [result for result in results if not result.success]
+    if failed:
+        raise PlaybookError(
+            f"{len(failed)} of {len(results)} playbook runs failed: "
+            + ", ".join(f"{result.run.label} ({result.error or result.status})" for result in failed)
+        )
+    logger.info(f"Completed {len(results)} playbook runs in {elapsed:.1f} seconds")
 
 def handle_provision(args: argparse.Namespace) -> None:
     """Handle server provisioning command."""
-    logger.info(f"Provisioning servers using playbook: {args.playbook}")
-    # TODO: Implement provisioning logic
-    pass
+    logger.info(f"Provisioning servers using playbook: {', '.join(args.playbook)}")
+    execute_playbooks(args)
 
 def handle_configure(args: argparse.Namespace) -> None:
     """Handle server configuration command."""
-    logger.info(f"Configuring servers using playbook: {args.playbook}")
-    # TODO: Implement configuration logic
-    pass
+    logger.info(f"Configuring servers using playbook: {', '.join(args.playbook)}")
+    
+    limit = None
+    if args.changed_only:
+        limit = load_delta_limit(args.changed_only)
+        if not limit:
+            logger.info("No added or changed hosts, nothing to configure")
+            return
+        logger.info(f"Limiting configuration to {len(limit)} added or changed hosts")
+        cache_dir = fact_cache_dir(args)
+        if cache_dir:
+            # Changed hosts may have new addresses, so their facts are gathered again
+            clear_cached_facts(cache_dir, limit)
+    
+    execute_playbooks(args, limit)
+
+def handle_check_pipelining(args: argparse.Namespace) -> None:
+    """Handle the pipelining check command."""
+    logger.info(f"Checking SSH pipelining with sudo on {args.inventory}")
+    
+    limit = args.limit.split(',') if args.limit else None
+    runner_options = {'forks': args.forks} if args.forks else {}
+    results = check_pipelining(args.inventory, ansible_envvars(args), limit, **runner_options)
+    
+    requiretty = sorted(host for host, status in results.items() if status == 'requiretty')
+    if requiretty:
+        logger.error(
+            f"sudo requires a tty on {len(requiretty)} hosts; remove 'Defaults requiretty' "
+            f"from their sudoers or run with --no-pipelining: {', '.join(requiretty)}"
+        )
+    failed = sorted(host for host, status in results.items() if status != 'ok')
+    if failed:
+        raise PlaybookError(f"Pipelining check failed on {len(failed)} of {len(results)} hosts")
+    logger.info(f"Pipelining works on all {len(results)} hosts")
 
 def main() -> Optional[int]:
     """Main entry point for the infrastructure automation tool."""
@@ -112,13 +391,24 @@ def main() -> Optional[int]:
         if not args.command:
             parser.print_help()
             return 1
+        check_ansible_config_arguments(parser, args)
+        
+        setup_logging(
+            args.log_file,
+            getattr(logging, args.log_level),
+            use_queue=args.log_queue,
+            log_format=args.log_format
+        )
+        if args.metrics_file:
+            export_metrics_at_exit(args.metrics_file, args.metrics_format)
         
         validate_environment()
         
         command_handlers = {
             'inventory': handle_inventory,
             'provision': handle_provision,
-            'configure': handle_configure
+            'configure': handle_configure,
+            'check-pipelining': handle_check_pipelining
         }
         
         handler = command_handlers.get(args.command)
@@ -0,0 +1,20 @@
+#!/usr/bin/env python3
+"""
+Ansible dynamic inventory script for AWS EC2.
+
+Usage:
+    ansible-playbook -i scripts/aws_ec2_inventory.py src/playbooks/webserver.yml
+
+See src/inventory/aws_inventory.py for the environment variables it reads.
+"""
+
+import os
+import sys
+
+# Make the python package importable regardless of the working directory
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..'))
+
+from python.src.inventory.aws_inventory import main
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -4,47 +4,215 @@ AWS Inventory Generator
 This module provides functionality to generate Ansible inventory from AWS EC2 instances.
 """
 
-import boto3
+import argparse
+import io
 import json
 import logging
-from typing import Dict, List, Optional
+import os
+import sys
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from typing import Dict, Iterable, Iterator, List, Optional, TextIO
 from botocore.exceptions import ClientError, NoCredentialsError, PartialCredentialsError
-from src.utils.exceptions import (
+from python.src.utils.exceptions import (
     CloudProviderError,
     InventoryError,
     AuthenticationError,
-    ResourceNotFoundError
+    ResourceNotFoundError,
+    ValidationError
 )
-from src.utils.logging_config import get_logger, LoggingContextManager
+from python.src.utils.aws_clients import client_registry
+from python.src.utils.retry import call_with_retry
+from python.src.utils.logging_config import get_logger, log_event, LoggingContextManager
+from python.src.utils.metrics import span, submit_in_context
+from python.src.inventory.cache import DEFAULT_MAX_AGE, InventoryCache
+from python.src.inventory.delta import (
+    InventoryDiffer,
+    delta_path,
+    load_previous_inventory,
+    write_delta
+)
+from python.src.inventory.grouping import InventoryGrouper
+from python.src.inventory.options import DEFAULT_INSTANCE_STATES, DEFAULT_REGION_WORKERS, INSTANCE_STATES
+from python.src.inventory.writer import InventoryWriter
 
 logger = get_logger(__name__)
 
+# Largest page size accepted by DescribeInstances
+DEFAULT_PAGE_SIZE = 1000
+
+# Region used to list the enabled regions when none is configured
+DEFAULT_SEED_REGION = 'us-east-1'
+
 class AWSInventoryGenerator:
     """Generate Ansible inventory from AWS EC2 instances."""
 
-    def __init__(self, region: str):
+    def __init__(
+        self,
+        region: str,
+        states: Optional[Iterable[str]] = None,
+        tags: Optional[Dict[str, List[str]]] = None,
+        cache: Optional[InventoryCache] = None,
+        refresh: bool = False,
+        profile: Optional[str] = None
+    ):
         """Initialize the AWS inventory generator.
         
+        The EC2 client is taken from the process-wide client registry on
+        first use, so generators served from the cache never build one.
+        
         Args:
             region: AWS region name
+            states: Instance states to include (defaults to running instances)
+            tags: Tag filters mapping tag keys to accepted values
+            cache: Optional on-disk cache for instance listings
+            refresh: Ignore cached listings and refresh them from the API
+            profile: AWS profile name, or None for the default credential chain
             
         Raises:
-            CloudProviderError: If region is invalid or AWS credentials are missing
+            ValidationError: If an unknown instance state is given
         """
+        self.filters = build_filters(states, tags)
+        self.cache = cache
+        self.refresh = refresh
+        self.region = region
+        self.profile = profile
+        self._ec2_client = None
+        logger.info(f"Initialized AWS inventory generator for region: {region}")
+
+    @property
+    def ec2_client(self):
+        """EC2 client for the region, shared with other generators.
+        
+        Raises:
+            AuthenticationError: If AWS credentials are missing
+            CloudProviderError: If the client cannot be created
+        """
+        if self._ec2_client is None:
+            try:
+                self._ec2_client = client_registry.client('ec2', self.region, self.profile)
+            except (NoCredentialsError, PartialCredentialsError) as e:
+                raise AuthenticationError(
+                    "AWS credentials not found or incomplete. "
+                    "Please set AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY environment variables."
+                ) from e
+            except ClientError as e:
+                raise CloudProviderError(f"Failed to initialize AWS client: {str(e)}") from e
+            except Exception as e:
+                raise CloudProviderError(f"Unexpected error initializing AWS client: {str(e)}") from e
+        return self._ec2_client
+
+    def iter_instances(self, filters: Optional[List[Dict]] = None,
+                       page_size: int = DEFAULT_PAGE_SIZE) -> Iterator[Dict]:
+        """Yield EC2 instances matching the specified filters, page by page.
+        
+        Results are fetched page by page following NextToken, so only one page
+        is held in memory at a time. Filtering is done server-side by the EC2
+        API. Throttled calls are retried with jittered exponential backoff
+        under a rate limiter shared by all generators.
+        
+        If the generator has a cache, a fresh cached listing is served instead
+        of calling the API, and API results are written through to the cache.
+        
+        Args:
+            filters: List of filter dictionaries for EC2 instances
+                (defaults to the state and tag filters of the generator)
+            page_size: Number of instances requested per API call
+            
+        Yields:
+            Instance information dictionaries
+            
+        Raises:
+            CloudProviderError: If AWS API call fails
+            InventoryError: If the cache cannot be read or written
+        """
+        if filters is None:
+            filters = self.filters
+        
+        if self.cache is None:
+            yield from self._describe_instances(filters, page_size)
+            return
+        
+        key = self._cache_key(filters)
+        if not self.refresh:
+            cached = self.cache.load(key)
+            if cached is not None:
+                yield from cached
+                return
+        
+        with self.cache.writer(key) as write_instance:
+            for instance in self._describe_instances(filters, page_size):
+                write_instance(instance)
+                yield instance
+
+    def _cache_key(self, filters: List[Dict]) -> str:
+        """Get the cache key of a listing with the given filters."""
+        return InventoryCache.make_key(
+            client_registry.credentials_identity(self.profile), self.region, filters
+        )
+    
+    def cached_instances(self) -> Optional[Iterator[Dict]]:
+        """Get the fresh cached listing of the generator's filters without calling the API.
+        
+        Returns:
+            Iterator over the cached instances, or None if there is no fresh
+            listing, no cache or the generator refreshes its listings
+        """
+        if self.cache is None or self.refresh:
+            return None
+        return self.cache.load(self._cache_key(self.filters))
+
+    def _describe_pages(self, filters: List[Dict], page_size: int) -> Iterator[Dict]:
+        """Yield describe_instances response pages, retrying each page call.
+        
+        Pages are requested one at a time rather than through a botocore
+        paginator, so a throttled page is retried on its own instead of
+        restarting the listing.
+        """
+        limiter = client_registry.rate_limiter('ec2', self.profile)
+        request = {'Filters': filters, 'MaxResults': page_size}
+        while True:
+            with span("aws.describe_instances"):
+                page = call_with_retry(self.ec2_client.describe_instances, limiter=limiter, **request)
+            yield page
+            
+            next_token = page.get('NextToken')
+            if not next_token:
+                return
+            request['NextToken'] = next_token
+
+    def _describe_instances(self, filters: List[Dict], page_size: int) -> Iterator[Dict]:
+        """Yield instances from the describe_instances pages."""
         try:
-            self.region = region
-            self.ec2_client = boto3.client('ec2', region_name=region)
-            self.ec2_resource = boto3.resource('ec2', region_name=region)
-            logger.info(f"Initialized AWS inventory generator for region: {region}")
-        except (NoCredentialsError, PartialCredentialsError) as e:
-            raise AuthenticationError(
-                "AWS credentials not found or incomplete. "
-                "Please set AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY environment variables."
-            ) from e
+            for page in self._describe_pages(filters, page_size):
+                for reservation in page['Reservations']:
+                    for instance in reservation['Instances']:
+                        instance_info = {
+                            'id': instance['InstanceId'],
+                            'type': instance['InstanceType'],
+                            'state': instance['State']['Name'],
+                            'private_ip': instance.get('PrivateIpAddress'),
+                            'public_ip': instance.get('PublicIpAddress'),
+                            'availability_zone': instance.get('Placement', {}).get('AvailabilityZone'),
+                            'vpc_id': instance.get('VpcId'),
+                            'region': self.region,
+                            'tags': {tag['Key']: tag['Value'] for tag in instance.get('Tags', [])}
+                        }
+                        log_event(logger, logging.DEBUG, "Found instance",
+                                  instance_id=instance_info['id'], region=self.region)
+                        yield instance_info
+        
         except ClientError as e:
-            raise CloudProviderError(f"Failed to initialize AWS client: {str(e)}") from e
+            error_code = e.response['Error']['Code']
+            error_message = e.response['Error']['Message']
+            logger.error(f"AWS API error: {error_code} - {error_message}")
+            raise CloudProviderError(
+                f"Failed to get EC2 instances: {error_message}"
+            ) from e
         except Exception as e:
-            raise CloudProviderError(f"Unexpected error initializing AWS client: {str(e)}") from e
+            logger.error("Unexpected error getting EC2 instances", exc_info=True)
+            raise CloudProviderError(
+                f"Unexpected error getting EC2 instances: {str(e)}"
+            ) from e
 
     def get_instances(self, filters: Optional[List[Dict]] = None) -> List[Dict]:
         """Get EC2 instances matching the specified filters.
@@ -59,123 +227,507 @@ class AWSInventoryGenerator:
             CloudProviderError: If AWS API call fails
             ResourceNotFoundError: If no instances are found
         """
-        with LoggingContextManager(logger, "fetching EC2 instances"):
-            try:
-                if filters is None:
-                    filters = []
-                
-                response = self.ec2_client.describe_instances(Filters=filters)
-                instances = []
-                
-                for reservation in response['Reservations']:
-                    for instance in reservation['Instances']:
-                        if instance['State']['Name'] == 'running':
-                            instance_info = {
-                                'id': instance['InstanceId'],
-                                'type': instance['InstanceType'],
-                                'state': instance['State']['Name'],
-                                'private_ip': instance.get('PrivateIpAddress'),
-                                'public_ip': instance.get('PublicIpAddress'),
-                                'tags': {tag['Key']: tag['Value'] for tag in instance.get('Tags', [])}
-                            }
-                            instances.append(instance_info)
-                            logger.debug(f"Found instance: {instance_info['id']}")
-                
-                if not instances:
-                    raise ResourceNotFoundError("No running EC2 instances found")
-                
-                logger.info(f"Found {len(instances)} running EC2 instances")
-                return instances
+        with LoggingContextManager(logger, "fetching EC2 instances", span="aws.fetch_instances"):
+            instances = list(self.iter_instances(filters))
             
-            except ClientError as e:
-                error_code = e.response['Error']['Code']
-                error_message = e.response['Error']['Message']
-                logger.error(f"AWS API error: {error_code} - {error_message}")
-                raise CloudProviderError(
-                    f"Failed to get EC2 instances: {error_message}"
-                ) from e
-            except Exception as e:
-                logger.error("Unexpected error getting EC2 instances", exc_info=True)
-                raise CloudProviderError(
-                    f"Unexpected error getting EC2 instances: {str(e)}"
-                ) from e
+            if not instances:
+                raise ResourceNotFoundError("No matching EC2 instances found")
+            
+            logger.info(f"Found {len(instances)} matching EC2 instances")
+            return instances
 
-    def generate_inventory(self, output_file: str) -> None:
+    def generate_inventory(
+        self,
+        output_file: str,
+        delta: bool = False,
+        compact: bool = False,
+        grouper: Optional[InventoryGrouper] = None
+    ) -> None:
         """Generate Ansible inventory file from EC2 instances.
         
+        Hosts are streamed into a temporary file while instances are fetched
+        and the file is renamed into place once complete.
+        
         Args:
             output_file: Path to output inventory file
+            delta: Also write the hosts changed since the previous file
+            compact: Write compact JSON instead of indented JSON
+            grouper: Group assignment (defaults to region and webservers groups)
             
         Raises:
             InventoryError: If inventory generation fails
             CloudProviderError: If AWS API call fails
         """
-        with LoggingContextManager(logger, "generating inventory"):
+        with LoggingContextManager(logger, "generating inventory", span="inventory.generate"):
             try:
-                instances = self.get_instances()
-                
-                inventory = {
-                    'all': {
-                        'hosts': {},
-                        'children': {
-                            'webservers': {
-                                'hosts': {}
-                            }
-                        }
-                    }
-                }
-                
-                for instance in instances:
-                    host_vars = {
-                        'ansible_host': instance['public_ip'] or instance['private_ip'],
-                        'ansible_user': 'ubuntu',  # Default user, can be overridden
-                        'instance_id': instance['id'],
-                        'instance_type': instance['type']
-                    }
+                grouper = grouper or InventoryGrouper()
+                writer = open_inventory_writer(output_file, [self.region], delta, compact, grouper)
+                with writer:
+                    host_count = add_instances(writer, self.iter_instances(), self.region, grouper)
                     
-                    # Add instance to all hosts
-                    inventory['all']['hosts'][instance['id']] = host_vars
-                    
-                    # Add to webservers group if tagged appropriately
-                    if instance['tags'].get('Role') == 'webserver':
-                        inventory['all']['children']['webservers']['hosts'][instance['id']] = host_vars
-                        logger.debug(f"Added instance {instance['id']} to webservers group")
+                    if not host_count:
+                        raise ResourceNotFoundError("No matching EC2 instances found")
                 
-                # Write inventory to file
-                try:
-                    with open(output_file, 'w') as f:
-                        json.dump(inventory, f, indent=2)
-                    logger.info(f"Inventory generated successfully: {output_file}")
-                except (IOError, OSError) as e:
-                    raise InventoryError(
-                        f"Failed to write inventory file: {str(e)}"
-                    ) from e
+                logger.info(f"Found {host_count} matching EC2 instances")
+                finish_inventory(writer)
                 
             except (CloudProviderError, ResourceNotFoundError) as e:
                 raise InventoryError(f"Failed to generate inventory: {str(e)}") from e
+            except InventoryError:
+                raise
             except Exception as e:
                 logger.error("Unexpected error generating inventory", exc_info=True)
                 raise InventoryError(
                     f"Unexpected error generating inventory: {str(e)}"
                 ) from e
 
-def generate_aws_inventory(region: str, output_file: str) -> None:
+    def list_regions(self) -> List[str]:
+        """List the regions enabled for the account.
+        
+        Returns:
+            Sorted list of region names
+            
+        Raises:
+            CloudProviderError: If AWS API call fails
+        """
+        try:
+            response = call_with_retry(
+                self.ec2_client.describe_regions,
+                limiter=client_registry.rate_limiter('ec2', self.profile)
+            )
+            return sorted(region['RegionName'] for region in response['Regions'])
+        except ClientError as e:
+            raise CloudProviderError(
+                f"Failed to list AWS regions: {e.response['Error']['Message']}"
+            ) from e
+
+def build_filters(
+    states: Optional[Iterable[str]] = None,
+    tags: Optional[Dict[str, List[str]]] = None
+) -> List[Dict]:
+    """Build describe_instances filters for instance states and tags.
+    
+    Args:
+        states: Instance states to include (defaults to running instances)
+        tags: Tag filters mapping tag keys to accepted values
+        
+    Returns:
+        List of filter dictionaries for the EC2 API
+        
+    Raises:
+        ValidationError: If an unknown instance state is given
+    """
+    states = list(states or DEFAULT_INSTANCE_STATES)
+    invalid_states = [state for state in states if state not in INSTANCE_STATES]
+    if invalid_states:
+        raise ValidationError(f"Invalid instance states: {', '.join(invalid_states)}")
+    
+    filters = [{'Name': 'instance-state-name', 'Values': states}]
+    for key, values in sorted((tags or {}).items()):
+        filters.append({'Name': f'tag:{key}', 'Values': list(values)})
+    return filters
+
+def parse_tag_filters(tag_args: Optional[List[str]]) -> Dict[str, List[str]]:
+    """Parse KEY=VALUE[,VALUE...] command-line tag filters.
+    
+    Args:
+        tag_args: Tag filter arguments; repeated keys accumulate values
+        
+    Returns:
+        Dictionary mapping tag keys to accepted values
+        
+    Raises:
+        ValidationError: If an argument is not of the form KEY=VALUE
+    """
+    tags: Dict[str, List[str]] = {}
+    for tag_arg in tag_args or []:
+        key, sep, values = tag_arg.partition('=')
+        if not sep or not key or not values:
+            raise ValidationError(f"Invalid tag filter {tag_arg!r}, expected KEY=VALUE[,VALUE...]")
+        tags.setdefault(key, []).extend(value for value in values.split(',') if value)
+    return tags
+
+def add_instances(
+    writer: InventoryWriter,
+    instances: Iterable[Dict],
+    region: str,
+    grouper: InventoryGrouper
+) -> int:
+    """Write instances to an inventory as they arrive.
+    
+    Every instance is added to the ``all`` hosts and, in the same pass, to
+    all groups the grouper assigns it to.
+    
+    Args:
+        writer: Open inventory writer
+        instances: Instance information dictionaries
+        region: AWS region the instances belong to
+        grouper: Group assignment
+        
+    Returns:
+        Number of instances added
+    """
+    host_count = 0
+    for instance in instances:
+        host_count += 1
+        with span("inventory.add_host"):
+            writer.add_host(instance['id'], build_host_vars(instance), grouper.groups_for(instance, region))
+    
+    return host_count
+
+def build_host_vars(instance: Dict) -> Dict:
+    """Build the Ansible host variables of an instance.
+    
+    Args:
+        instance: Instance information dictionary
+        
+    Returns:
+        Host variables dictionary
+    """
+    return {
+        'ansible_host': instance['public_ip'] or instance['private_ip'],
+        'ansible_user': 'ubuntu',  # Default user, can be overridden
+        'instance_id': instance['id'],
+        'instance_type': instance['type']
+    }
+
+def open_inventory_writer(
+    output_file: str,
+    regions: List[str],
+    delta: bool = False,
+    compact: bool = False,
+    grouper: Optional[InventoryGrouper] = None
+) -> InventoryWriter:
+    """Create the writer for an inventory covering the given regions.
+    
+    Args:
+        output_file: Path to output inventory file
+        regions: AWS regions whose groups the inventory declares
+        delta: Compare written hosts against the previous contents of output_file
+        compact: Write compact JSON instead of indented JSON
+        grouper: Group assignment declaring the default groups
+        
+    Returns:
+        Inventory writer, to be used as a context manager
+    """
+    differ = InventoryDiffer(load_previous_inventory(output_file)) if delta else None
+    groups = (grouper or InventoryGrouper()).declared_groups(regions)
+    return InventoryWriter(output_file, compact=compact, groups=groups, differ=differ)
+
+def finish_inventory(writer: InventoryWriter) -> None:
+    """Write the delta of a completed inventory, if it was requested.
+    
+    Args:
+        writer: Closed inventory writer
+        
+    Raises:
+        InventoryError: If the delta file cannot be written
+    """
+    if writer.differ is not None:
+        with span("inventory.write_delta"):
+            write_delta(writer.differ.result(), delta_path(writer.output_file))
+
+def resolve_regions(region_arg: str) -> List[str]:
+    """Resolve a --region argument into a list of region names.
+    
+    Args:
+        region_arg: Single region, comma-separated list of regions or ``all``
+        
+    Returns:
+        List of region names
+        
+    Raises:
+        ValidationError: If no region is given
+        CloudProviderError: If enabled regions cannot be listed
+    """
+    if region_arg.strip().lower() == 'all':
+        seed_region = os.getenv('AWS_DEFAULT_REGION', DEFAULT_SEED_REGION)
+        return AWSInventoryGenerator(seed_region).list_regions()
+    
+    regions = []
+    for region in region_arg.split(','):
+        region = region.strip()
+        if region and region not in regions:
+            regions.append(region)
+    
+    if not regions:
+        raise ValidationError(f"No region given in: {region_arg!r}")
+    return regions
+
+def generate_aws_inventory(
+    region: str,
+    output_file: str,
+    states: Optional[Iterable[str]] = None,
+    tags: Optional[Dict[str, List[str]]] = None,
+    cache: Optional[InventoryCache] = None,
+    refresh: bool = False,
+    delta: bool = False,
+    compact: bool = False,
+    group_by: Optional[List[str]] = None
+) -> None:
     """Generate AWS inventory file.
     
     Args:
         region: AWS region name
         output_file: Path to output inventory file
+        states: Instance states to include (defaults to running instances)
+        tags: Tag filters mapping tag keys to accepted values
+        cache: Optional on-disk cache for instance listings
+        refresh: Ignore cached listings and refresh them from the API
+        delta: Also write the hosts changed since the previous file
+        compact: Write compact JSON instead of indented JSON
+        group_by: KEY[=PREFIX] specifications of additional keyed groups
         
     Raises:
         CloudProviderError: If AWS client initialization fails
         InventoryError: If inventory generation fails
     """
     try:
-        generator = AWSInventoryGenerator(region)
-        generator.generate_inventory(output_file)
+        generator = AWSInventoryGenerator(
+            region, states=states, tags=tags, cache=cache, refresh=refresh
+        )
+        generator.generate_inventory(
+            output_file, delta=delta, compact=compact, grouper=InventoryGrouper(group_by)
+        )
     except (CloudProviderError, InventoryError) as e:
         logger.error(f"Failed to generate AWS inventory: {str(e)}", exc_info=True)
         raise
     except Exception as e:
         logger.error("Unexpected error in generate_aws_inventory", exc_info=True)
-        raise InventoryError(f"Unexpected error: {str(e)}") from e 
\ No newline at end of file
+        raise InventoryError(f"Unexpected error: {str(e)}") from e
+
+def _fetch_region_instances(region: str, **generator_args) -> List[Dict]:
+    """Fetch the matching instances of one region (worker for the region pool)."""
+    generator = AWSInventoryGenerator(region, **generator_args)
+    return list(generator.iter_instances())
+
+def stream_regions(
+    writer: InventoryWriter,
+    regions: List[str],
+    max_workers: int = DEFAULT_REGION_WORKERS,
+    grouper: Optional[InventoryGrouper] = None,
+    **generator_args
+) -> int:
+    """Write the instances of several regions to an open inventory writer.
+    
+    A single region is streamed page by page. Several regions are queried
+    concurrently by a bounded thread pool and written as they complete.
+    
+    Args:
+        writer: Open inventory writer
+        regions: AWS region names
+        max_workers: Maximum number of regions queried at the same time
+        grouper: Group assignment (defaults to region and webservers groups)
+        **generator_args: Arguments for AWSInventoryGenerator
+        
+    Returns:
+        Number of instances written
+        
+    Raises:
+        InventoryError: If any region fails
+    """
+    grouper = grouper or InventoryGrouper()
+    if len(regions) == 1:
+        try:
+            generator = AWSInventoryGenerator(regions[0], **generator_args)
+            return add_instances(writer, generator.iter_instances(), regions[0], grouper)
+        except CloudProviderError as e:
+            raise InventoryError(f"Failed to generate inventory: {str(e)}") from e
+    
+    host_count = 0
+    failed_regions = {}
+    
+    with ThreadPoolExecutor(max_workers=max(1, min(max_workers, len(regions)))) as executor:
+        futures = {
+            submit_in_context(executor, _fetch_region_instances, region, **generator_args): region
+            for region in regions
+        }
+        for future in as_completed(futures):
+            region = futures[future]
+            try:
+                instances = future.result()
+            except Exception as e:
+                logger.error(f"Failed to fetch instances in {region}: {str(e)}")
+                failed_regions[region] = str(e)
+                continue
+            
+            # Writing happens on this thread only, so no locking is needed
+            host_count += add_instances(writer, instances, region, grouper)
+            logger.info(f"Found {len(instances)} matching EC2 instances in {region}")
+    
+    if failed_regions:
+        raise InventoryError(
+            "Failed to generate inventory for regions: "
+            + ", ".join(sorted(failed_regions))
+        )
+    return host_count
+
+def generate_multi_region_inventory(
+    regions: List[str],
+    output_file: str,
+    max_workers: int = DEFAULT_REGION_WORKERS,
+    states: Optional[Iterable[str]] = None,
+    tags: Optional[Dict[str, List[str]]] = None,
+    cache: Optional[InventoryCache] = None,
+    refresh: bool = False,
+    delta: bool = False,
+    compact: bool = False,
+    group_by: Optional[List[str]] = None
+) -> None:
+    """Generate one AWS inventory file covering several regions.
+    
+    Regions are queried concurrently by a bounded thread pool and streamed
+    into a single inventory as they complete, with one group per region.
+    
+    Args:
+        regions: AWS region names
+        output_file: Path to output inventory file
+        max_workers: Maximum number of regions queried at the same time
+        states: Instance states to include (defaults to running instances)
+        tags: Tag filters mapping tag keys to accepted values
+        cache: Optional on-disk cache for instance listings
+        refresh: Ignore cached listings and refresh them from the API
+        delta: Also write the hosts changed since the previous file
+        compact: Write compact JSON instead of indented JSON
+        group_by: KEY[=PREFIX] specifications of additional keyed groups
+        
+    Raises:
+        InventoryError: If any region fails or no instances are found
+    """
+    with LoggingContextManager(logger, f"generating inventory for {len(regions)} regions",
+                               span="inventory.generate_multi_region"):
+        grouper = InventoryGrouper(group_by)
+        writer = open_inventory_writer(output_file, regions, delta, compact, grouper)
+        
+        with writer:
+            host_count = stream_regions(
+                writer, regions, max_workers, grouper,
+                states=states, tags=tags, cache=cache, refresh=refresh
+            )
+            if not host_count:
+                raise InventoryError("Failed to generate inventory: No matching EC2 instances found")
+        
+        logger.info(f"Found {host_count} matching EC2 instances in {len(regions)} regions")
+        finish_inventory(writer)
+
+def write_dynamic_inventory(
+    regions: List[str],
+    stream: TextIO,
+    max_workers: int = DEFAULT_REGION_WORKERS,
+    grouper: Optional[InventoryGrouper] = None,
+    **generator_args
+) -> int:
+    """Write the dynamic inventory ``--list`` output for several regions.
+    
+    Host variables are included in ``_meta.hostvars``, so Ansible does not
+    call the script with ``--host`` for every host.
+    
+    Args:
+        regions: AWS region names
+        stream: Open text stream, e.g. sys.stdout
+        max_workers: Maximum number of regions queried at the same time
+        grouper: Group assignment (defaults to region and webservers groups)
+        **generator_args: Arguments for AWSInventoryGenerator
+        
+    Returns:
+        Number of instances written
+        
+    Raises:
+        InventoryError: If any region fails
+    """
+    grouper = grouper or InventoryGrouper()
+    writer = InventoryWriter(
+        None,
+        compact=True,
+        groups=grouper.declared_groups(regions),
+        script_format=True,
+        stream=stream
+    )
+    with writer:
+        return stream_regions(writer, regions, max_workers, grouper, **generator_args)
+
+def find_host_vars(regions: List[str], host: str, **generator_args) -> Dict:
+    """Find the host variables of one host for the dynamic inventory ``--host`` output.
+    
+    Fresh cached listings are searched first. Otherwise each region is asked
+    for the instance by its ID, rather than listing every instance of the
+    account; these single-host answers are not cached.
+    
+    Args:
+        regions: AWS region names
+        host: Inventory hostname (instance ID)
+        **generator_args: Arguments for AWSInventoryGenerator
+        
+    Returns:
+        Host variables, or an empty dictionary if the host is unknown
+    """
+    generators = [AWSInventoryGenerator(region, **generator_args) for region in regions]
+    for generator in generators:
+        for instance in generator.cached_instances() or ():
+            if instance['id'] == host:
+                return build_host_vars(instance)
+    
+    for generator in generators:
+        lookup = AWSInventoryGenerator(
+            generator.region, **{**generator_args, 'cache': None}
+        )
+        filters = generator.filters + [{'Name': 'instance-id', 'Values': [host]}]
+        for instance in lookup.iter_instances(filters):
+            if instance['id'] == host:
+                return build_host_vars(instance)
+    return {}
+
+def main(argv: Optional[List[str]] = None) -> int:
+    """Run as an Ansible dynamic inventory script.
+    
+    The script is configured through environment variables:
+    INFRA_INVENTORY_REGIONS (region, comma-separated list or ``all``),
+    INFRA_INVENTORY_STATES (comma-separated instance states),
+    INFRA_INVENTORY_TAGS (space-separated KEY=VALUE[,VALUE] filters),
+    INFRA_INVENTORY_GROUP_BY (space-separated KEY[=PREFIX] keyed groups) and
+    INFRA_INVENTORY_MAX_AGE (cache age in seconds, 0 disables the cache).
+    
+    Args:
+        argv: Command-line arguments, defaults to sys.argv
+        
+    Returns:
+        Exit code
+    """
+    parser = argparse.ArgumentParser(description='AWS EC2 dynamic inventory')
+    mode = parser.add_mutually_exclusive_group(required=True)
+    mode.add_argument('--list', action='store_true', help='List all groups and hosts')
+    mode.add_argument('--host', help='Show the variables of one host')
+    args = parser.parse_args(argv)
+    
+    # stdout carries the inventory, so log to stderr only
+    logging.basicConfig(level=logging.WARNING, stream=sys.stderr)
+    
+    try:
+        regions = resolve_regions(
+            os.getenv('INFRA_INVENTORY_REGIONS') or os.getenv('AWS_DEFAULT_REGION', DEFAULT_SEED_REGION)
+        )
+        states = [state for state in os.getenv('INFRA_INVENTORY_STATES', '').split(',') if state]
+        max_age = float(os.getenv('INFRA_INVENTORY_MAX_AGE', DEFAULT_MAX_AGE))
+        generator_args = {
+            'states': states or None,
+            'tags': parse_tag_filters(os.getenv('INFRA_INVENTORY_TAGS', '').split()),
+            'cache': InventoryCache(max_age=max_age) if max_age > 0 else None
+        }
+        
+        if args.list:
+            grouper = InventoryGrouper(os.getenv('INFRA_INVENTORY_GROUP_BY', '').split())
+            # Buffered, so a region that fails midway never leaves Ansible a
+            # truncated document on stdout
+            output = io.StringIO()
+            write_dynamic_inventory(regions, output, grouper=grouper, **generator_args)
+            sys.stdout.write(output.getvalue())
+        else:
+            json.dump(find_host_vars(regions, args.host, **generator_args), sys.stdout)
+            sys.stdout.write('\n')
+        return 0
+    except Exception as e:
+        logger.error(f"Failed to generate dynamic inventory: {str(e)}")
+        return 1
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,148 @@
+"""
+Inventory Cache
+
+This module provides an on-disk cache for cloud instance listings, so repeated
+inventory runs can be served without calling the provider API.
+"""
+
+import hashlib
+import json
+import os
+import tempfile
+import time
+from contextlib import contextmanager
+from typing import Callable, Dict, Iterator, List, Optional
+from python.src.utils.exceptions import InventoryError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+# Default location of cache entries
+DEFAULT_CACHE_DIR = "~/.cache/infra-automation/inventory"
+
+# Default maximum age of a cache entry in seconds
+DEFAULT_MAX_AGE = 300
+
+# Version of the cached instance format; bump it whenever the fields written
+# for an instance change, so entries in the old format are never read back
+CACHE_FORMAT_VERSION = 2
+
+class InventoryCache:
+    """Cache instance listings on disk, keyed by account, region and filters.
+    
+    Each entry is a JSON Lines file holding one instance per line, so entries
+    are written and read back one instance at a time. Entries are written to a
+    temporary file and renamed into place, so readers never see partial data.
+    """
+
+    def __init__(self, cache_dir: str = DEFAULT_CACHE_DIR, max_age: float = DEFAULT_MAX_AGE):
+        """Initialize the inventory cache.
+        
+        Args:
+            cache_dir: Directory holding cache entries
+            max_age: Maximum age of a usable entry in seconds
+            
+        Raises:
+            InventoryError: If cache directory creation fails
+        """
+        try:
+            self.cache_dir = os.path.expanduser(cache_dir)
+            self.max_age = max_age
+            os.makedirs(self.cache_dir, mode=0o700, exist_ok=True)
+            logger.debug("Initialized inventory cache in %s", self.cache_dir)
+        except OSError as e:
+            raise InventoryError(
+                f"Failed to create inventory cache directory: {str(e)}"
+            ) from e
+
+    @staticmethod
+    def make_key(account: str, region: str, filters: List[Dict]) -> str:
+        """Build the cache key for an instance listing.
+        
+        Args:
+            account: Identity of the credentials used for the listing
+            region: Cloud region name
+            filters: Filters applied to the listing
+            
+        Returns:
+            Hex digest identifying the listing
+        """
+        material = json.dumps(
+            {'version': CACHE_FORMAT_VERSION, 'account': account, 'region': region,
+             'filters': filters},
+            sort_keys=True
+        )
+        return hashlib.sha256(material.encode('utf-8')).hexdigest()
+
+    def _entry_path(self, key: str) -> str:
+        """Get the path of the cache entry for a key."""
+        return os.path.join(self.cache_dir, f"{key}.jsonl")
+
+    def load(self, key: str) -> Optional[Iterator[Dict]]:
+        """Load a cache entry if it exists and is fresh.
+        
+        Args:
+            key: Cache key from make_key()
+            
+        Returns:
+            Iterator over the cached instances, or None on a cache miss
+        """
+        path = self._entry_path(key)
+        try:
+            age = time.time() - os.stat(path).st_mtime
+        except FileNotFoundError:
+            logger.debug("Inventory cache miss: %s", key)
+            return None
+        
+        if age > self.max_age:
+            logger.debug("Inventory cache entry expired after %.0f seconds: %s", age, key)
+            return None
+        
+        logger.info(f"Serving instances from inventory cache ({age:.0f} seconds old)")
+        return self._read_entry(path)
+
+    @staticmethod
+    def _read_entry(path: str) -> Iterator[Dict]:
+        """Read the instances of a cache entry one line at a time."""
+        try:
+            with open(path, 'r', encoding='utf-8') as f:
+                for line in f:
+                    yield json.loads(line)
+        except (IOError, OSError, ValueError) as e:
+            raise InventoryError(f"Failed to read inventory cache entry: {str(e)}") from e
+
+    @contextmanager
+    def writer(self, key: str) -> Iterator[Callable[[Dict], None]]:
+        """Write a cache entry one instance at a time.
+        
+        The entry replaces any previous entry for the key only if the block
+        completes; on error or early exit the partial entry is discarded.
+        
+        Args:
+            key: Cache key from make_key()
+            
+        Yields:
+            Callable that appends one instance to the entry
+            
+        Raises:
+            InventoryError: If the entry cannot be written
+        """
+        try:
+            fd, temp_path = tempfile.mkstemp(dir=self.cache_dir, prefix='.tmp-', suffix='.jsonl')
+        except OSError as e:
+            raise InventoryError(f"Failed to create inventory cache entry: {str(e)}") from e
+        
+        try:
+            with os.fdopen(fd, 'w', encoding='utf-8') as f:
+                yield lambda instance: f.write(json.dumps(instance) + '\n')
+            try:
+                os.replace(temp_path, self._entry_path(key))
+            except OSError as e:
+                raise InventoryError(f"Failed to store inventory cache entry: {str(e)}") from e
+            logger.debug("Stored inventory cache entry: %s", key)
+        except BaseException:
+            try:
+                os.unlink(temp_path)
+            except OSError:
+                pass
+            raise
\ No newline at end of file
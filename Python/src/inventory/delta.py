@@ -0,0 +1,175 @@
+"""
+Inventory Delta
+
+This module computes which hosts were added, removed or changed between two
+generations of an inventory, so later steps can target only changed hosts.
+"""
+
+import json
+import os
+import time
+import tempfile
+from typing import Dict, Iterable, List, Optional
+from python.src.utils.exceptions import InventoryError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+class InventoryDiffer:
+    """Compare hosts of a new inventory against a previous one.
+    
+    Hosts of the new inventory are observed one at a time, so the new
+    inventory never has to be held in memory as a whole.
+    """
+
+    def __init__(self, previous: Optional[Dict] = None):
+        """Initialize the differ.
+        
+        Args:
+            previous: Previous inventory structure, or None if there is none
+        """
+        previous = previous or {}
+        self._previous_hosts = previous.get('all', {}).get('hosts', {})
+        self._previous_groups = host_groups(previous)
+        self._seen = set()
+        self.added: List[str] = []
+        self.changed: Dict[str, List[str]] = {}
+
+    def observe(self, host_id: str, host_vars: Dict, groups: Iterable[str]) -> None:
+        """Compare one host of the new inventory against the previous inventory.
+        
+        Args:
+            host_id: Inventory hostname
+            host_vars: Host variables in the new inventory
+            groups: Groups the host belongs to in the new inventory
+        """
+        self._seen.add(host_id)
+        
+        previous_vars = self._previous_hosts.get(host_id)
+        if previous_vars is None:
+            self.added.append(host_id)
+            return
+        
+        changed_keys = sorted(
+            key for key in set(previous_vars) | set(host_vars)
+            if previous_vars.get(key) != host_vars.get(key)
+        )
+        if sorted(groups) != self._previous_groups.get(host_id, []):
+            changed_keys.append('groups')
+        if changed_keys:
+            self.changed[host_id] = changed_keys
+
+    def result(self) -> Dict:
+        """Build the delta once every host of the new inventory was observed.
+        
+        Returns:
+            Delta dictionary with added, removed and changed hosts
+        """
+        removed = [host_id for host_id in self._previous_hosts if host_id not in self._seen]
+        return {
+            'generated_at': time.strftime('%Y-%m-%dT%H:%M:%SZ', time.gmtime()),
+            'added': sorted(self.added),
+            'removed': sorted(removed),
+            'changed': dict(sorted(self.changed.items())),
+            'unchanged': len(self._seen) - len(self.added) - len(self.changed)
+        }
+
+def host_groups(inventory: Dict) -> Dict[str, List[str]]:
+    """Map every host of an inventory to the sorted list of its groups.
+    
+    Args:
+        inventory: Inventory structure
+        
+    Returns:
+        Dictionary mapping hostnames to group names
+    """
+    groups: Dict[str, List[str]] = {}
+    for group, group_data in inventory.get('all', {}).get('children', {}).items():
+        for host_id in (group_data or {}).get('hosts', {}) or {}:
+            groups.setdefault(host_id, []).append(group)
+    for group_list in groups.values():
+        group_list.sort()
+    return groups
+
+def delta_path(output_file: str) -> str:
+    """Get the path of the delta file written next to an inventory file.
+    
+    Args:
+        output_file: Path to the inventory file
+        
+    Returns:
+        Path of the delta file, e.g. ``aws.delta.json`` for ``aws.json``
+    """
+    root, _ = os.path.splitext(output_file)
+    return f"{root}.delta.json"
+
+def load_previous_inventory(output_file: str) -> Optional[Dict]:
+    """Load the inventory previously written to a path.
+    
+    Args:
+        output_file: Path to the inventory file
+        
+    Returns:
+        Previous inventory structure, or None if there is no usable file
+    """
+    try:
+        with open(output_file, 'r') as f:
+            return json.load(f)
+    except FileNotFoundError:
+        return None
+    except (IOError, OSError, ValueError) as e:
+        logger.warning(f"Ignoring unreadable previous inventory {output_file}: {str(e)}")
+        return None
+
+def write_delta(delta: Dict, path: str) -> None:
+    """Write a delta to a file.
+    
+    The delta is written to a temporary file and renamed into place, so a
+    failed write never leaves a truncated delta for --changed-only to read.
+    
+    Args:
+        delta: Delta dictionary from InventoryDiffer.result()
+        path: Path of the delta file
+        
+    Raises:
+        InventoryError: If the file cannot be written
+    """
+    try:
+        fd, temp_path = tempfile.mkstemp(
+            dir=os.path.dirname(os.path.abspath(path)), prefix='.tmp-', suffix='.json'
+        )
+        try:
+            with os.fdopen(fd, 'w') as f:
+                json.dump(delta, f, indent=2)
+            os.replace(temp_path, path)
+        except BaseException:
+            try:
+                os.unlink(temp_path)
+            except OSError:
+                pass
+            raise
+        logger.info(
+            f"Inventory delta written to {path}: {len(delta['added'])} added, "
+            f"{len(delta['removed'])} removed, {len(delta['changed'])} changed"
+        )
+    except (IOError, OSError) as e:
+        raise InventoryError(f"Failed to write inventory delta: {str(e)}") from e
+
+def load_delta_limit(path: str) -> List[str]:
+    """Get the hosts that need configuration according to a delta file.
+    
+    Args:
+        path: Path of the delta file
+        
+    Returns:
+        Sorted list of added and changed hosts
+        
+    Raises:
+        InventoryError: If the delta file cannot be read
+    """
+    try:
+        with open(path, 'r') as f:
+            delta = json.load(f)
+        return sorted(set(delta['added']) | set(delta['changed']))
+    except (IOError, OSError, ValueError, KeyError) as e:
+        raise InventoryError(f"Failed to read inventory delta {path}: {str(e)}") from e
@@ -0,0 +1,162 @@
+"""
+Inventory Grouping
+
+This module assigns inventory hosts to groups derived from instance
+attributes, such as tags, instance type, availability zone or VPC.
+"""
+
+import re
+from typing import Callable, Dict, Iterable, List, Optional
+from python.src.utils.exceptions import ValidationError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+# Group of hosts tagged Role=webserver
+WEBSERVERS_GROUP = 'webservers'
+
+# Group keys for instance attributes, mapped to instance information fields
+_INSTANCE_FIELDS = {
+    'instance_type': 'type',
+    'availability_zone': 'availability_zone',
+    'vpc_id': 'vpc_id',
+    'region': 'region'
+}
+
+# Instance attributes available as group keys, besides tag:<key>
+INSTANCE_KEYS = tuple(_INSTANCE_FIELDS)
+
+# Characters that are not valid in Ansible group names
+_INVALID_GROUP_CHARS = re.compile(r'[^A-Za-z0-9_]')
+
+def sanitize_group_name(name: str) -> str:
+    """Turn a string into a valid Ansible group name.
+    
+    Args:
+        name: Raw group name
+        
+    Returns:
+        Group name with invalid characters replaced by underscores
+    """
+    return _INVALID_GROUP_CHARS.sub('_', name)
+
+def region_group_name(region: str) -> str:
+    """Get the inventory group name for a region.
+    
+    Args:
+        region: Cloud region name
+        
+    Returns:
+        Group name that is a valid Ansible identifier, e.g. ``us_west_2``
+    """
+    return sanitize_group_name(region)
+
+def _compile_key(key: str) -> Callable[[Dict], Optional[str]]:
+    """Build the function extracting a group key value from an instance."""
+    if key.startswith('tag:'):
+        tag_key = key[len('tag:'):]
+        if not tag_key:
+            raise ValidationError(f"Invalid group key {key!r}, expected tag:<key>")
+        return lambda instance: instance['tags'].get(tag_key)
+    if key in _INSTANCE_FIELDS:
+        field = _INSTANCE_FIELDS[key]
+        return lambda instance: instance.get(field)
+    raise ValidationError(
+        f"Invalid group key {key!r}, expected tag:<key> or one of: {', '.join(INSTANCE_KEYS)}"
+    )
+
+class KeyedGroup:
+    """Group hosts by the value of one instance attribute.
+    
+    A host whose attribute has the value ``v`` joins the group ``<prefix>_v``.
+    Group names are computed once per distinct value and then looked up.
+    """
+
+    def __init__(self, spec: str):
+        """Initialize a keyed group from a KEY[=PREFIX] specification.
+        
+        Args:
+            spec: Group key, e.g. ``tag:Env`` or ``instance_type=type``,
+                with an optional group name prefix after ``=``
+                
+        Raises:
+            ValidationError: If the key is not supported
+        """
+        key, _, prefix = spec.partition('=')
+        self.key = key
+        self.prefix = sanitize_group_name(prefix or key.replace(':', '_'))
+        self._extract = _compile_key(key)
+        self._names: Dict[str, str] = {}
+
+    def group_for(self, instance: Dict) -> Optional[str]:
+        """Get the group of an instance.
+        
+        Args:
+            instance: Instance information dictionary
+            
+        Returns:
+            Group name, or None if the instance has no value for the key
+        """
+        value = self._extract(instance)
+        if value is None or value == '':
+            return None
+        
+        name = self._names.get(value)
+        if name is None:
+            name = self._names[value] = sanitize_group_name(f"{self.prefix}_{value}")
+        return name
+
+class InventoryGrouper:
+    """Assign instances to all their groups in a single pass.
+    
+    Every instance joins the group of its region and, if tagged
+    Role=webserver, the webservers group. Keyed groups add one group per
+    distinct value of each configured key.
+    """
+
+    def __init__(self, group_by: Optional[Iterable[str]] = None):
+        """Initialize the grouper.
+        
+        Args:
+            group_by: KEY[=PREFIX] keyed group specifications
+            
+        Raises:
+            ValidationError: If a key is not supported
+        """
+        self.keyed_groups: List[KeyedGroup] = [KeyedGroup(spec) for spec in group_by or []]
+        self._region_groups: Dict[str, str] = {}
+
+    def declared_groups(self, regions: Iterable[str]) -> List[str]:
+        """Get the groups an inventory declares even if they stay empty.
+        
+        Args:
+            regions: Regions covered by the inventory
+            
+        Returns:
+            Group names
+        """
+        return [WEBSERVERS_GROUP] + [region_group_name(region) for region in regions]
+
+    def groups_for(self, instance: Dict, region: str) -> List[str]:
+        """Get all groups of an instance.
+        
+        Args:
+            instance: Instance information dictionary
+            region: Region the instance belongs to
+            
+        Returns:
+            Group names
+        """
+        region_group = self._region_groups.get(region)
+        if region_group is None:
+            region_group = self._region_groups[region] = region_group_name(region)
+        groups = [region_group]
+        
+        if instance['tags'].get('Role') == 'webserver':
+            groups.append(WEBSERVERS_GROUP)
+        
+        for keyed_group in self.keyed_groups:
+            group = keyed_group.group_for(instance)
+            if group is not None and group not in groups:
+                groups.append(group)
+        return groups
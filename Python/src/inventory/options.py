@@ -0,0 +1,16 @@
+"""
+Inventory Options
+
+Defaults and valid values of the inventory options. They live apart from
+aws_inventory so the CLI can build its argument parser without importing
+boto3 and botocore.
+"""
+
+# Number of regions queried concurrently in multi-region mode
+DEFAULT_REGION_WORKERS = 8
+
+# Instance states included when no state filter is given
+DEFAULT_INSTANCE_STATES = ('running',)
+
+# Valid values for the instance-state-name filter
+INSTANCE_STATES = ('pending', 'running', 'shutting-down', 'terminated', 'stopping', 'stopped')
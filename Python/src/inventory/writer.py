@@ -0,0 +1,206 @@
+"""
+Inventory Writer
+
+This module provides a streaming writer for Ansible JSON inventory files.
+Host entries are serialized as they arrive into a temporary file, which is
+renamed over the destination only once the inventory is complete. The writer
+can also stream the dynamic inventory script format (``--list`` output) to an
+open stream such as stdout.
+"""
+
+import json
+import os
+import tempfile
+from typing import Dict, Iterable, List, Optional, TextIO
+from python.src.inventory.delta import InventoryDiffer
+from python.src.utils.exceptions import InventoryError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+# Mode of newly created inventory files
+DEFAULT_FILE_MODE = 0o644
+
+class InventoryWriter:
+    """Stream an Ansible inventory to a file and replace the file atomically.
+    
+    Host variables are written to ``all.hosts`` as soon as a host is added;
+    only the group membership (hostnames) is kept in memory until the groups
+    are written under ``all.children`` when the writer is closed. Concurrent
+    readers see either the previous file or the complete new one.
+    
+    In script format, host variables are written to ``_meta.hostvars`` and
+    groups are written as top-level ``{"hosts": [...]}`` entries, as expected
+    from the ``--list`` output of a dynamic inventory script.
+    
+    Usage:
+        with InventoryWriter(output_file, groups=['webservers']) as writer:
+            writer.add_host('i-123', {'ansible_host': '10.0.0.1'}, ['webservers'])
+    """
+
+    def __init__(
+        self,
+        output_file: Optional[str],
+        compact: bool = False,
+        groups: Iterable[str] = (),
+        differ: Optional[InventoryDiffer] = None,
+        script_format: bool = False,
+        stream: Optional[TextIO] = None
+    ):
+        """Initialize the inventory writer.
+        
+        Args:
+            output_file: Path to output inventory file, or None to write to stream
+            compact: Write compact JSON instead of indented JSON
+            groups: Groups written even if no host is added to them
+            differ: Optional differ observing every host written
+            script_format: Write the dynamic inventory script format
+            stream: Open text stream written to when output_file is None
+        """
+        self.output_file = output_file
+        self.compact = compact
+        self.differ = differ
+        self.script_format = script_format
+        self.stream = stream
+        self.host_count = 0
+        self._groups: Dict[str, List[str]] = {group: [] for group in groups}
+        self._file = None
+        self._temp_path = None
+
+    def _newline(self, level: int) -> str:
+        """Get the line break and indentation for a nesting level."""
+        return '' if self.compact else '\n' + '  ' * level
+
+    def _dump(self, value, level: int) -> str:
+        """Serialize a value nested at the given level."""
+        if self.compact:
+            return json.dumps(value, separators=(',', ':'))
+        return json.dumps(value, indent=2).replace('\n', self._newline(level))
+
+    def _key(self, key: str, level: int, first: bool) -> str:
+        """Serialize an object key nested at the given level."""
+        separator = '' if self.compact else ' '
+        return f"{'' if first else ','}{self._newline(level)}{json.dumps(key)}:{separator}"
+
+    def __enter__(self) -> 'InventoryWriter':
+        """Create the temporary file and write the inventory header."""
+        try:
+            if self.output_file is None:
+                self._file = self.stream
+            else:
+                fd, self._temp_path = tempfile.mkstemp(
+                    dir=os.path.dirname(os.path.abspath(self.output_file)),
+                    prefix=f".{os.path.basename(self.output_file)}.",
+                    suffix='.tmp'
+                )
+                self._file = os.fdopen(fd, 'w', encoding='utf-8')
+            
+            outer, inner = ('_meta', 'hostvars') if self.script_format else ('all', 'hosts')
+            self._file.write(
+                '{' + self._key(outer, 1, True) + '{' + self._key(inner, 2, True) + '{'
+            )
+        except (IOError, OSError) as e:
+            self._discard()
+            raise InventoryError(
+                f"Failed to write inventory file: {str(e)}"
+            ) from e
+        return self
+
+    def add_host(self, host_id: str, host_vars: Dict, groups: Iterable[str] = ()) -> None:
+        """Write one host entry.
+        
+        Args:
+            host_id: Inventory hostname
+            host_vars: Host variables
+            groups: Groups the host belongs to
+            
+        Raises:
+            InventoryError: If the entry cannot be written
+        """
+        groups = list(groups)
+        try:
+            self._file.write(
+                self._key(host_id, 3, self.host_count == 0) + self._dump(host_vars, 3)
+            )
+        except (IOError, OSError) as e:
+            raise InventoryError(
+                f"Failed to write inventory file: {str(e)}"
+            ) from e
+        
+        for group in groups:
+            self._groups.setdefault(group, []).append(host_id)
+        if self.differ is not None:
+            self.differ.observe(host_id, host_vars, groups)
+        self.host_count += 1
+
+    def _write_script_groups(self) -> None:
+        """Write the groups in script format and close the inventory structure."""
+        write = self._file.write
+        write((self._newline(2) if self.host_count else '') + '}' + self._newline(1) + '}')
+        for group, hosts in self._groups.items():
+            write(self._key(group, 1, False) + '{' + self._key('hosts', 2, True) + self._dump(hosts, 2))
+            write(self._newline(1) + '}')
+        children = ['ungrouped'] + list(self._groups)
+        write(self._key('all', 1, False) + '{' + self._key('children', 2, True) + self._dump(children, 2))
+        write(self._newline(1) + '}' + self._newline(0) + '}' + ('' if self.compact else '\n'))
+
+    def _write_groups(self) -> None:
+        """Write the group membership and close the inventory structure."""
+        if self.script_format:
+            self._write_script_groups()
+            return
+        
+        write = self._file.write
+        write((self._newline(2) if self.host_count else '') + '}' + self._key('children', 2, False) + '{')
+        for group_index, (group, hosts) in enumerate(self._groups.items()):
+            write(self._key(group, 3, group_index == 0) + '{' + self._key('hosts', 4, True) + '{')
+            for host_index, host_id in enumerate(hosts):
+                write(self._key(host_id, 5, host_index == 0) + '{}')
+            write((self._newline(4) if hosts else '') + '}' + self._newline(3) + '}')
+        write((self._newline(2) if self._groups else '') + '}' + self._newline(1) + '}')
+        write(self._newline(0) + '}' + ('' if self.compact else '\n'))
+
+    def _file_mode(self) -> int:
+        """Get the mode for the new file, keeping the mode of an existing file."""
+        try:
+            return os.stat(self.output_file).st_mode & 0o777
+        except OSError:
+            return DEFAULT_FILE_MODE
+
+    def _discard(self) -> None:
+        """Close and remove the temporary file."""
+        if self._file is not None and self._file is not self.stream:
+            self._file.close()
+        self._file = None
+        if self._temp_path is not None:
+            try:
+                os.unlink(self._temp_path)
+            except OSError:
+                pass
+            self._temp_path = None
+
+    def __exit__(self, exc_type, exc_val, exc_tb) -> None:
+        """Complete and rename the file into place, or discard it on error."""
+        if exc_type is not None:
+            self._discard()
+            return
+        
+        try:
+            self._write_groups()
+            self._file.flush()
+            if self.output_file is None:
+                return
+            
+            os.fsync(self._file.fileno())
+            self._file.close()
+            self._file = None
+            os.chmod(self._temp_path, self._file_mode())
+            os.replace(self._temp_path, self.output_file)
+            self._temp_path = None
+            logger.info(f"Inventory generated successfully: {self.output_file}")
+        except (IOError, OSError) as e:
+            raise InventoryError(
+                f"Failed to write inventory file: {str(e)}"
+            ) from e
+        finally:
+            self._discard()
@@ -0,0 +1,140 @@
+"""
+Tuned Ansible Settings
+
+This module tunes the SSH connection settings of the tool's playbook runs.
+With SSH pipelining, Ansible runs a module over the existing SSH session
+instead of copying it to a temporary file first, and persistent
+ControlMaster connections let every task of a host reuse one SSH
+connection. Control sockets are named by OpenSSH's %C connection hash, so
+their length doesn't depend on host names.
+
+The settings are passed as ANSIBLE_* environment variables, which take
+precedence over the matching ansible.cfg options but leave every other
+option of the project or user configuration in effect.
+
+Pipelining doesn't work with sudo on hosts whose sudoers sets requiretty;
+see playbook_runner.check_pipelining.
+
+With a fact cache directory, gathered facts are kept in JSON files and
+plays only run the setup module on hosts without fresh cached facts.
+"""
+
+import os
+from dataclasses import dataclass
+from typing import Dict, Iterable, Optional, Tuple
+from python.src.utils.exceptions import ConfigurationError
+from python.src.utils.logging_config import get_logger
+from python.src.utils.ssh_manager import CONTROL_PATH_TOKEN, DEFAULT_CONTROL_PERSIST
+
+logger = get_logger(__name__)
+
+# SSHManager's default control directory, so Ansible reuses the master
+# connections opened by SSHManager with multiplexing enabled
+DEFAULT_CONTROL_DIR = "~/.ssh/cm"
+# SSH options added to the ControlMaster options
+DEFAULT_SSH_ARGS = ("-C", "-o ServerAliveInterval=30")
+# Longest Unix socket path (macOS; Linux allows 108)
+MAX_SOCKET_PATH = 104
+# Characters ssh appends to the control path while a master connection starts
+CONTROL_PATH_SUFFIX = 17
+# Length of the %C connection hash
+CONNECTION_HASH_LENGTH = 40
+# Directory of the fact cache, relative to the working directory
+DEFAULT_FACT_CACHE_DIR = ".infra_automation/facts"
+# Seconds cached facts stay valid
+DEFAULT_FACT_CACHE_TIMEOUT = 86400
+
+@dataclass
+class AnsibleConfig:
+    """Tuned Ansible settings of a playbook run."""
+    pipelining: bool = True
+    control_persist: int = DEFAULT_CONTROL_PERSIST
+    control_dir: str = DEFAULT_CONTROL_DIR
+    ssh_args: Tuple[str, ...] = DEFAULT_SSH_ARGS
+    fact_cache_dir: Optional[str] = None
+    fact_cache_timeout: int = DEFAULT_FACT_CACHE_TIMEOUT
+    
+    def validate(self) -> None:
+        """Check that control sockets fit the Unix socket path limit.
+        
+        Raises:
+            ConfigurationError: If the control directory path is too long
+        """
+        directory = os.path.expanduser(self.control_dir)
+        length = len(directory) + 1 + CONNECTION_HASH_LENGTH + CONTROL_PATH_SUFFIX
+        if length > MAX_SOCKET_PATH:
+            raise ConfigurationError(
+                f"Control directory {directory} is too long for SSH control sockets: "
+                f"use a path of at most "
+                f"{MAX_SOCKET_PATH - 1 - CONNECTION_HASH_LENGTH - CONTROL_PATH_SUFFIX} characters"
+            )
+    
+    def envvars(self) -> Dict[str, str]:
+        """Get the settings as Ansible environment variables."""
+        ssh_args = " ".join((
+            *self.ssh_args,
+            "-o ControlMaster=auto",
+            f"-o ControlPersist={self.control_persist}s",
+        ))
+        control_dir = os.path.abspath(os.path.expanduser(self.control_dir))
+        envvars = {
+            'ANSIBLE_PIPELINING': str(self.pipelining),
+            'ANSIBLE_SSH_ARGS': ssh_args,
+            'ANSIBLE_SSH_CONTROL_PATH_DIR': control_dir,
+            # The path names the directory rather than %(directory)s, which
+            # ansible-runner may point at its temporary private data directory.
+            # Ansible %-formats the path, so the OpenSSH token is escaped
+            'ANSIBLE_SSH_CONTROL_PATH':
+                os.path.join(control_dir, CONTROL_PATH_TOKEN).replace('%', '%%'),
+        }
+        if self.fact_cache_dir:
+            envvars.update({
+                # Only gather facts of hosts without fresh cached facts
+                'ANSIBLE_GATHERING': 'smart',
+                'ANSIBLE_CACHE_PLUGIN': 'jsonfile',
+                'ANSIBLE_CACHE_PLUGIN_CONNECTION': os.path.abspath(self.fact_cache_dir),
+                'ANSIBLE_CACHE_PLUGIN_TIMEOUT': str(self.fact_cache_timeout),
+            })
+        return envvars
+    
+    def prepare(self) -> Dict[str, str]:
+        """Validate the settings and create the directories they use.
+        
+        Returns:
+            The settings as Ansible environment variables
+        
+        Raises:
+            ConfigurationError: If the settings are invalid or a directory can't be created
+        """
+        self.validate()
+        try:
+            os.makedirs(os.path.expanduser(self.control_dir), mode=0o700, exist_ok=True)
+            if self.fact_cache_dir:
+                os.makedirs(self.fact_cache_dir, mode=0o700, exist_ok=True)
+        except OSError as e:
+            raise ConfigurationError(f"Failed to create Ansible directories: {str(e)}") from e
+        return self.envvars()
+
+def clear_cached_facts(cache_dir: str, hosts: Iterable[str]) -> int:
+    """Remove the cached facts of hosts, so the next run gathers them again.
+    
+    Args:
+        cache_dir: Fact cache directory
+        hosts: Inventory host names
+    
+    Returns:
+        Number of cache entries removed
+    """
+    removed = 0
+    for host in hosts:
+        # The jsonfile cache stores each host's facts in a file named after it
+        try:
+            os.unlink(os.path.join(cache_dir, host))
+            removed += 1
+        except FileNotFoundError:
+            continue
+        except OSError as e:
+            logger.warning(f"Failed to remove cached facts of {host}: {str(e)}")
+    if removed:
+        logger.info(f"Removed cached facts of {removed} hosts")
+    return removed
@@ -0,0 +1,201 @@
+"""
+Asynchronous SSH Engine
+
+This module checks SSH connectivity and collects host keys with asyncssh, an
+optional dependency, instead of spawning an ssh or ssh-keyscan process per
+host. All handshakes run as coroutines on one event loop, bounded by a
+semaphore, so checking thousands of hosts is limited by the network rather
+than by process creation.
+"""
+
+import asyncio
+import logging
+import time
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+from python.src.utils.exceptions import SSHManagerError
+from python.src.utils.known_hosts import known_hosts_entry
+from python.src.utils.logging_config import get_logger, log_event
+from python.src.utils.metrics import span
+from python.src.utils.ssh_manager import ConnectivityResult, DEADLINE_EXCEEDED, DEFAULT_CONNECT_TIMEOUT
+
+logger = get_logger(__name__)
+
+# Handshakes in flight at the same time
+DEFAULT_CONCURRENCY = 500
+# Command run to prove that a session can be opened
+CHECK_COMMAND = "true"
+
+def _load_asyncssh() -> Any:
+    """Import asyncssh.
+    
+    Raises:
+        SSHManagerError: If asyncssh is not installed
+    """
+    try:
+        import asyncssh
+    except ImportError as e:
+        raise SSHManagerError(
+            "The async SSH engine requires asyncssh: pip install asyncssh"
+        ) from e
+    return asyncssh
+
+class AsyncSSHEngine:
+    """Run SSH checks and host key scans as coroutines."""
+
+    def __init__(self, concurrency: int = DEFAULT_CONCURRENCY,
+                 connect_timeout: float = DEFAULT_CONNECT_TIMEOUT):
+        """Initialize the engine.
+        
+        Args:
+            concurrency: Maximum number of handshakes in flight
+            connect_timeout: Seconds allowed for each host
+        
+        Raises:
+            SSHManagerError: If asyncssh is not installed
+        """
+        self._asyncssh = _load_asyncssh()
+        self.concurrency = max(1, concurrency)
+        self.connect_timeout = connect_timeout
+        self._private_keys: Dict[str, Any] = {}
+
+    def _client_key(self, private_key_path: str) -> Any:
+        """Load a private key once and reuse it for every connection.
+        
+        Raises:
+            SSHManagerError: If the key can't be read
+        """
+        key = self._private_keys.get(private_key_path)
+        if key is None:
+            try:
+                key = self._asyncssh.read_private_key(private_key_path)
+            except Exception as e:
+                raise SSHManagerError(
+                    f"Failed to load private key {private_key_path}: {str(e)}"
+                ) from e
+            self._private_keys[private_key_path] = key
+        return key
+
+    async def check(self, host: str, user: str, private_key_path: str, port: int = 22,
+                    timeout: Optional[float] = None) -> ConnectivityResult:
+        """Open an SSH session to a host and run a no-op command.
+        
+        Args:
+            host: Target host
+            user: SSH user
+            private_key_path: Path of the private key
+            port: SSH port
+            timeout: Seconds allowed for the check
+        
+        Returns:
+            ConnectivityResult for the host; a key that can't be loaded fails
+            the check rather than raising, so it doesn't abort a batch
+        """
+        timeout = self.connect_timeout if timeout is None else timeout
+        started = time.monotonic()
+        
+        async def run() -> Tuple[bool, Optional[str]]:
+            client_key = self._client_key(private_key_path)
+            async with self._asyncssh.connect(
+                host,
+                port=port,
+                username=user,
+                client_keys=[client_key],
+                known_hosts=None,
+                connect_timeout=timeout
+            ) as conn:
+                result = await conn.run(CHECK_COMMAND, check=False)
+            if result.exit_status == 0:
+                return True, None
+            return False, f"exit status {result.exit_status}"
+        
+        try:
+            with span("ssh.check_async"):
+                success, error = await asyncio.wait_for(run(), timeout)
+        except asyncio.TimeoutError:
+            success, error = False, "timed out"
+        except Exception as e:
+            success, error = False, str(e) or type(e).__name__
+        return ConnectivityResult(host, user, success, time.monotonic() - started, error)
+
+    async def check_many(
+        self,
+        hosts: Iterable[Tuple[str, str]],
+        private_key_path: str,
+        port: int = 22,
+        deadline: Optional[float] = None,
+        concurrency: Optional[int] = None
+    ) -> Dict[str, ConnectivityResult]:
+        """Check many hosts concurrently.
+        
+        Args:
+            hosts: (host, user) pairs to check
+            private_key_path: Path of the private key
+            port: SSH port
+            deadline: Seconds allowed for the whole batch, or None for no limit
+            concurrency: Handshakes in flight (defaults to the engine setting)
+        
+        Returns:
+            Dictionary of host to ConnectivityResult
+        """
+        targets = list(hosts)
+        semaphore = asyncio.Semaphore(max(1, concurrency or self.concurrency))
+        deadline_at = time.monotonic() + deadline if deadline is not None else None
+        
+        async def bounded_check(host: str, user: str) -> ConnectivityResult:
+            async with semaphore:
+                timeout = self.connect_timeout
+                if deadline_at is not None:
+                    timeout = min(timeout, deadline_at - time.monotonic())
+                    if timeout <= 0:
+                        return ConnectivityResult(host, user, False, 0.0, DEADLINE_EXCEEDED)
+                return await self.check(host, user, private_key_path, port, timeout)
+        
+        results = await asyncio.gather(
+            *(bounded_check(host, user) for host, user in targets)
+        )
+        return {result.host: result for result in results}
+
+    async def scan_host_key(self, host: str, port: int = 22) -> Optional[str]:
+        """Fetch the host key a server presents, as a known_hosts line.
+        
+        Args:
+            host: Target host
+            port: SSH port
+        
+        Returns:
+            known_hosts line, or None if the host could not be reached
+        """
+        try:
+            key = await asyncio.wait_for(
+                self._asyncssh.get_server_host_key(host, port),
+                self.connect_timeout
+            )
+        except Exception as e:
+            log_event(logger, logging.DEBUG, "Failed to get host key",
+                      host=host, error=str(e) or type(e).__name__)
+            return None
+        if key is None:
+            return None
+        public_key = key.export_public_key('openssh').decode().split()
+        return f"{known_hosts_entry(host, port)} {public_key[0]} {public_key[1]}"
+
+    async def scan_host_keys(self, hosts: Iterable[str],
+                             port: int = 22) -> Dict[str, Optional[str]]:
+        """Fetch the host keys of many servers concurrently.
+        
+        Args:
+            hosts: Target hosts
+            port: SSH port
+        
+        Returns:
+            Dictionary of host to known_hosts line, or None if unreachable
+        """
+        targets: List[str] = list(hosts)
+        semaphore = asyncio.Semaphore(self.concurrency)
+        
+        async def bounded_scan(host: str) -> Optional[str]:
+            async with semaphore:
+                return await self.scan_host_key(host, port)
+        
+        lines = await asyncio.gather(*(bounded_scan(host) for host in targets))
+        return dict(zip(targets, lines))
@@ -0,0 +1,124 @@
+"""
+AWS Client Registry
+
+This module provides a process-wide registry of boto3 sessions and clients.
+Building a client loads botocore service models, which is expensive; sharing
+one session per profile and one client per service and region lets repeated
+and multi-region operations reuse warm clients and their connection pools.
+The registry also holds the rate limiters shared by all callers of a service.
+"""
+
+import threading
+from typing import Any, Dict, Optional, Tuple
+import boto3
+from botocore.config import Config
+from python.src.utils.logging_config import get_logger
+from python.src.utils.retry import TokenBucket
+
+logger = get_logger(__name__)
+
+# Retries are done by src.utils.retry.call_with_retry, which shares a rate
+# limiter between workers; botocore's own retries would multiply attempts
+CLIENT_CONFIG = Config(retries={'mode': 'standard', 'total_max_attempts': 1})
+
+class AWSClientRegistry:
+    """Thread-safe registry of lazily created boto3 sessions and clients."""
+
+    def __init__(self):
+        """Initialize an empty registry."""
+        self._lock = threading.Lock()
+        self._sessions: Dict[Optional[str], boto3.session.Session] = {}
+        self._clients: Dict[Tuple[str, str, Optional[str]], Any] = {}
+        self._limiters: Dict[Tuple[str, Optional[str]], TokenBucket] = {}
+
+    def _get_session(self, profile: Optional[str]) -> boto3.session.Session:
+        """Get the session of a profile; the caller must hold the lock."""
+        session = self._sessions.get(profile)
+        if session is None:
+            session = boto3.session.Session(profile_name=profile)
+            self._sessions[profile] = session
+            logger.debug("Created AWS session for profile: %s", profile or 'default')
+        return session
+
+    def session(self, profile: Optional[str] = None) -> boto3.session.Session:
+        """Get the shared session of a profile.
+        
+        Args:
+            profile: AWS profile name, or None for the default credential chain
+            
+        Returns:
+            boto3 session
+        """
+        with self._lock:
+            return self._get_session(profile)
+
+    def client(self, service: str, region: str, profile: Optional[str] = None) -> Any:
+        """Get the shared client of a service in a region.
+        
+        Clients are created on first use. boto3 clients are thread-safe, so
+        one client is shared by all threads.
+        
+        Args:
+            service: AWS service name, e.g. ``ec2``
+            region: AWS region name
+            profile: AWS profile name, or None for the default credential chain
+            
+        Returns:
+            boto3 client
+        """
+        key = (service, region, profile)
+        client = self._clients.get(key)
+        if client is not None:
+            return client
+        
+        # Sessions are not thread-safe, so clients are created under the lock
+        with self._lock:
+            client = self._clients.get(key)
+            if client is None:
+                client = self._get_session(profile).client(
+                    service, region_name=region, config=CLIENT_CONFIG
+                )
+                self._clients[key] = client
+                logger.debug("Created AWS %s client for region: %s", service, region)
+            return client
+
+    def rate_limiter(self, service: str, profile: Optional[str] = None) -> TokenBucket:
+        """Get the rate limiter shared by all callers of a service.
+        
+        Args:
+            service: AWS service name, e.g. ``ec2``
+            profile: AWS profile name, or None for the default credential chain
+            
+        Returns:
+            Token bucket shared across threads and regions
+        """
+        with self._lock:
+            limiter = self._limiters.get((service, profile))
+            if limiter is None:
+                limiter = self._limiters[(service, profile)] = TokenBucket()
+            return limiter
+
+    def credentials_identity(self, profile: Optional[str] = None) -> str:
+        """Identify the credentials of a profile without calling the API.
+        
+        Args:
+            profile: AWS profile name, or None for the default credential chain
+            
+        Returns:
+            Access key ID of the resolved credentials, or the profile name if
+            no credentials are available
+        """
+        credentials = self.session(profile).get_credentials()
+        if credentials is None:
+            return f"profile:{profile or 'default'}"
+        return str(credentials.access_key)
+
+    def clear(self) -> None:
+        """Drop all sessions and clients."""
+        with self._lock:
+            self._sessions.clear()
+            self._clients.clear()
+            self._limiters.clear()
+
+# Registry shared by the whole process
+client_registry = AWSClientRegistry()
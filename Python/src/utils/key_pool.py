@@ -0,0 +1,163 @@
+"""
+SSH Key Pool
+
+This module pre-generates ed25519 key pairs on a background thread so that
+creating many ephemeral environments at once doesn't serialize on ssh-keygen.
+Keys are generated in-process with the cryptography package and handed out
+from a bounded queue; when the queue is empty a key is generated inline.
+"""
+
+import queue
+import getpass
+import socket
+import threading
+from typing import Any, Callable, Optional, Tuple
+from python.src.utils.exceptions import SSHManagerError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+# Key pairs kept ready by default
+DEFAULT_POOL_DEPTH = 8
+# Seconds the filler waits before retrying after a failed generation
+FILL_RETRY_DELAY = 1.0
+
+def _load_serialization() -> Any:
+    """Import the cryptography serialization module.
+    
+    Raises:
+        SSHManagerError: If cryptography is not installed
+    """
+    try:
+        from cryptography.hazmat.primitives import serialization
+    except ImportError as e:
+        raise SSHManagerError(
+            "The SSH key pool requires cryptography: pip install cryptography"
+        ) from e
+    return serialization
+
+def new_ed25519_key() -> Any:
+    """Generate an ed25519 private key.
+    
+    Raises:
+        SSHManagerError: If cryptography is not installed
+    """
+    _load_serialization()
+    from cryptography.hazmat.primitives.asymmetric.ed25519 import Ed25519PrivateKey
+    return Ed25519PrivateKey.generate()
+
+def default_key_comment() -> str:
+    """Build the user@host comment ssh-keygen adds to new keys."""
+    try:
+        user = getpass.getuser()
+    except (KeyError, OSError):
+        user = "unknown"
+    return f"{user}@{socket.gethostname()}"
+
+def serialize_key_pair(private_key: Any, comment: Optional[str] = None) -> Tuple[bytes, str]:
+    """Encode an unencrypted private key in the formats ssh-keygen writes.
+    
+    Passphrase-protected keys are generated by ssh-keygen instead of the pool.
+    
+    Args:
+        private_key: cryptography private key
+        comment: Public key comment (defaults to user@host)
+    
+    Returns:
+        Tuple of (OpenSSH private key bytes, public key line)
+    
+    Raises:
+        SSHManagerError: If cryptography is not installed
+    """
+    serialization = _load_serialization()
+    private_bytes = private_key.private_bytes(
+        serialization.Encoding.PEM,
+        serialization.PrivateFormat.OpenSSH,
+        serialization.NoEncryption()
+    )
+    public_key = private_key.public_key().public_bytes(
+        serialization.Encoding.OpenSSH,
+        serialization.PublicFormat.OpenSSH
+    ).decode()
+    return private_bytes, f"{public_key} {comment or default_key_comment()}"
+
+class KeyPool:
+    """Background pool of pre-generated private keys."""
+
+    def __init__(self, depth: int = DEFAULT_POOL_DEPTH,
+                 generate: Optional[Callable[[], Any]] = None):
+        """Initialize the pool and start filling it.
+        
+        Args:
+            depth: Number of keys kept ready
+            generate: Key factory (defaults to new_ed25519_key)
+        
+        Raises:
+            SSHManagerError: If cryptography is not installed and no factory is given
+        """
+        if generate is None:
+            _load_serialization()
+            generate = new_ed25519_key
+        self.depth = max(1, depth)
+        self.misses = 0
+        self._misses_lock = threading.Lock()
+        self._generate = generate
+        self._keys: 'queue.Queue[Any]' = queue.Queue(maxsize=self.depth)
+        self._closed = threading.Event()
+        self._thread = threading.Thread(target=self._fill, name="ssh-key-pool", daemon=True)
+        self._thread.start()
+        logger.debug("Started SSH key pool with depth %d", self.depth)
+
+    def __enter__(self) -> 'KeyPool':
+        """Enter the context; the pool is closed on exit."""
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb) -> None:
+        """Exit the context and stop the filler thread."""
+        self.close()
+
+    @property
+    def size(self) -> int:
+        """Number of keys ready to be handed out."""
+        return self._keys.qsize()
+
+    def _fill(self) -> None:
+        """Keep the queue full until the pool is closed."""
+        while not self._closed.is_set():
+            try:
+                key = self._generate()
+            except Exception as e:
+                logger.error(f"Failed to pre-generate SSH key: {str(e)}")
+                self._closed.wait(FILL_RETRY_DELAY)
+                continue
+            
+            while not self._closed.is_set():
+                try:
+                    self._keys.put(key, timeout=0.5)
+                    break
+                except queue.Full:
+                    continue
+
+    def acquire(self) -> Any:
+        """Take a pre-generated key, generating one inline if the pool is empty.
+        
+        Returns:
+            cryptography private key
+        """
+        try:
+            return self._keys.get_nowait()
+        except queue.Empty:
+            with self._misses_lock:
+                self.misses += 1
+            logger.debug("SSH key pool empty, generating key inline")
+            return self._generate()
+
+    def close(self) -> None:
+        """Stop the filler thread and drop the remaining keys."""
+        self._closed.set()
+        self._thread.join(timeout=5)
+        while True:
+            try:
+                self._keys.get_nowait()
+            except queue.Empty:
+                break
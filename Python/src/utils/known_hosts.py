@@ -0,0 +1,335 @@
+"""
+known_hosts File Management
+
+This module keeps an OpenSSH known_hosts file free of duplicates. Entries are
+indexed by (host, key type), so re-scanning a host replaces its keys instead
+of appending another copy, and looking up a host doesn't scan the file.
+Hashed entries are indexed by salt, so a host is hashed once per distinct
+salt, and the hashed entries found for a host are kept until the file
+changes on disk.
+Updated keys are written back in place, in the hashed form if the entry was
+hashed, and every other line keeps its position and text. Changes are
+written to a temporary file and renamed into place so ssh never reads a
+partially written file.
+"""
+
+import os
+import hmac
+import base64
+import hashlib
+import tempfile
+import threading
+from dataclasses import dataclass
+from typing import Dict, Iterable, List, Optional, Tuple
+from python.src.utils.exceptions import SSHManagerError
+from python.src.utils.logging_config import get_logger
+
+logger = get_logger(__name__)
+
+# Mode of a newly created known_hosts file
+DEFAULT_KNOWN_HOSTS_MODE = 0o600
+# Prefix of entries written with HashKnownHosts
+HASHED_ENTRY_PREFIX = "|1|"
+
+def known_hosts_entry(host: str, port: int = 22) -> str:
+    """Format a host the way OpenSSH writes it in known_hosts."""
+    return host if port == 22 else f"[{host}]:{port}"
+
+def parse_known_hosts_line(line: str) -> Optional[Tuple[List[str], str, str]]:
+    """Split a known_hosts line into hosts, key type and key.
+    
+    Returns:
+        Tuple of (hosts, key type, key and comment), or None for comments,
+        @cert-authority/@revoked markers and malformed lines
+    """
+    line = line.strip()
+    if not line or line.startswith(('#', '@')):
+        return None
+    parts = line.split(None, 2)
+    if len(parts) < 3:
+        return None
+    return parts[0].split(','), parts[1], parts[2]
+
+def _parse_hashed_entry(entry: str) -> Optional[Tuple[bytes, bytes]]:
+    """Split a HashKnownHosts entry (|1|salt|hash) into its salt and hash."""
+    try:
+        salt, digest = entry[len(HASHED_ENTRY_PREFIX):].split('|', 1)
+        return base64.b64decode(salt), base64.b64decode(digest)
+    except (ValueError, TypeError):
+        return None
+
+def _hash_host(salt: bytes, host: str) -> bytes:
+    """Hash a host name with a salt the way HashKnownHosts does."""
+    return hmac.new(salt, host.encode(), hashlib.sha1).digest()
+
+def _hashed_entry_matches(entry: str, host: str) -> bool:
+    """Check a HashKnownHosts entry against a host name."""
+    parsed = _parse_hashed_entry(entry)
+    return parsed is not None and hmac.compare_digest(_hash_host(parsed[0], host), parsed[1])
+
+@dataclass
+class KnownHostsLine:
+    """A line of a known_hosts file.
+    
+    Comments, markers and malformed lines only have text; entries also have
+    their host names, key type and key. text is None once an entry changed,
+    so it is rendered from its fields.
+    """
+    text: Optional[str]
+    names: Optional[List[str]] = None
+    key_type: Optional[str] = None
+    key: Optional[str] = None
+    
+    def render(self) -> str:
+        """Get the text of the line."""
+        if self.text is not None:
+            return self.text
+        return f"{','.join(self.names)} {self.key_type} {self.key}"
+
+class KnownHostsFile:
+    """Deduplicated, indexed view of a known_hosts file."""
+
+    def __init__(self, path: str):
+        """Initialize the known_hosts file.
+        
+        Args:
+            path: Path of the known_hosts file
+        """
+        self.path = path
+        self._lock = threading.Lock()
+        self._lines: List[KnownHostsLine] = []
+        # plain host -> its entries, in file order
+        self._hosts: Dict[str, List[KnownHostsLine]] = {}
+        # salt -> hash -> hashed entries, so a host is hashed once per salt
+        self._salts: Dict[bytes, Dict[bytes, List[KnownHostsLine]]] = {}
+        # host -> its hashed entries, kept until the file is reloaded
+        self._hashed_matches: Dict[str, List[KnownHostsLine]] = {}
+        self._positions: Dict[int, int] = {}
+        self._signature: Optional[Tuple[int, int]] = None
+        self._loaded = False
+
+    def _stat(self) -> Optional[Tuple[int, int]]:
+        """Get the modification time and size of the file, or None if it doesn't exist."""
+        try:
+            stat = os.stat(self.path)
+        except FileNotFoundError:
+            return None
+        return stat.st_mtime_ns, stat.st_size
+
+    def _load(self) -> None:
+        """Read the file unless the loaded copy is current; the caller must hold the lock."""
+        signature = self._stat()
+        if self._loaded and signature == self._signature:
+            return
+        
+        lines: List[KnownHostsLine] = []
+        if signature is not None:
+            with open(self.path, 'r') as f:
+                for line in f:
+                    text = line.rstrip('\n')
+                    parsed = parse_known_hosts_line(text)
+                    if parsed is None:
+                        lines.append(KnownHostsLine(text))
+                    else:
+                        lines.append(KnownHostsLine(text, *parsed))
+        
+        self._lines = lines
+        self._hashed_matches = {}
+        self._index()
+        self._signature = signature
+        self._loaded = True
+
+    def _index(self) -> None:
+        """Rebuild the host index from the lines; the caller must hold the lock."""
+        hosts: Dict[str, List[KnownHostsLine]] = {}
+        salts: Dict[bytes, Dict[bytes, List[KnownHostsLine]]] = {}
+        for line in self._lines:
+            for name in line.names or ():
+                if not name.startswith(HASHED_ENTRY_PREFIX):
+                    hosts.setdefault(name, []).append(line)
+                    continue
+                parsed = _parse_hashed_entry(name)
+                if parsed is not None:
+                    salt, digest = parsed
+                    salts.setdefault(salt, {}).setdefault(digest, []).append(line)
+        self._hosts, self._salts = hosts, salts
+        self._positions = {id(line): position for position, line in enumerate(self._lines)}
+        # Removed lines drop out of the cached matches; _drop_name forgets the
+        # matches of the hosts it removes
+        self._hashed_matches = {
+            host: [line for line in lines if id(line) in self._positions]
+            for host, lines in self._hashed_matches.items()
+        }
+    
+    def _hashed_entries(self, host: str) -> List[KnownHostsLine]:
+        """Get the hashed entries of a host; the caller must hold the lock."""
+        matches = self._hashed_matches.get(host)
+        if matches is None:
+            matches = []
+            for salt, digests in self._salts.items():
+                matches.extend(digests.get(_hash_host(salt, host), ()))
+            self._hashed_matches[host] = matches
+        return matches
+    
+    def _entries(self, host: str, key_type: Optional[str] = None) -> List[KnownHostsLine]:
+        """Get the entries of a host in file order; the caller must hold the lock.
+        
+        Args:
+            host: known_hosts host entry
+            key_type: Only return entries with this key type
+        """
+        entries = {id(line): line for line in self._hosts.get(host, []) + self._hashed_entries(host)}
+        return sorted(
+            (line for line in entries.values() if key_type is None or line.key_type == key_type),
+            key=lambda line: self._positions[id(line)]
+        )
+    
+    def _save(self) -> None:
+        """Atomically replace the file with the current lines; the caller must hold the lock."""
+        directory = os.path.dirname(os.path.abspath(self.path))
+        os.makedirs(directory, mode=0o700, exist_ok=True)
+        try:
+            mode = os.stat(self.path).st_mode & 0o777
+        except OSError:
+            mode = DEFAULT_KNOWN_HOSTS_MODE
+        
+        fd, temp_path = tempfile.mkstemp(dir=directory, prefix=".known_hosts.")
+        try:
+            with os.fdopen(fd, 'w') as f:
+                for line in self._lines:
+                    f.write(f"{line.render()}\n")
+                f.flush()
+                os.fsync(f.fileno())
+            os.chmod(temp_path, mode)
+            os.replace(temp_path, self.path)
+        except OSError:
+            try:
+                os.unlink(temp_path)
+            except OSError:
+                pass
+            raise
+        self._signature = self._stat()
+
+    def lookup(self, host: str, port: int = 22) -> Dict[str, str]:
+        """Get the known keys of a host.
+        
+        Args:
+            host: Host name or address
+            port: SSH port
+        
+        Returns:
+            Dictionary of key type to key
+        """
+        entry = known_hosts_entry(host, port)
+        with self._lock:
+            self._load()
+            keys: Dict[str, str] = {}
+            for line in self._entries(entry):
+                keys.setdefault(line.key_type, line.key)
+        return keys
+
+    def merge(self, lines: Iterable[str]) -> Tuple[int, int]:
+        """Add scanned host keys, replacing existing keys of the same host and type.
+        
+        Args:
+            lines: known_hosts lines, e.g. ssh-keyscan output
+        
+        Returns:
+            Tuple of (keys added, keys replaced)
+        
+        Raises:
+            SSHManagerError: If the file can't be read or written
+        """
+        scanned: Dict[Tuple[str, str], str] = {}
+        for line in lines:
+            parsed = parse_known_hosts_line(line)
+            if parsed is None:
+                continue
+            hosts, key_type, key = parsed
+            for host in hosts:
+                scanned[(host, key_type)] = key
+        if not scanned:
+            return 0, 0
+        
+        with self._lock:
+            try:
+                self._load()
+                added = replaced = 0
+                changed = False
+                for (host, key_type), key in scanned.items():
+                    entries = self._entries(host, key_type)
+                    if not entries:
+                        self._lines.append(KnownHostsLine(None, [host], key_type, key))
+                        added += 1
+                        changed = True
+                        continue
+                    
+                    # Update the host's own entry in place, keeping it hashed if it
+                    # is; a shared "host,address" entry keeps its other names
+                    target = next((line for line in entries if len(line.names) == 1), entries[0])
+                    if target.key != key:
+                        replaced += 1
+                        changed = True
+                        if len(target.names) == 1:
+                            target.key, target.text = key, None
+                        else:
+                            self._drop_name(target, host)
+                            position = self._lines.index(target) + 1
+                            self._lines.insert(position, KnownHostsLine(None, [host], key_type, key))
+                    for line in entries:
+                        if line is not target:
+                            self._drop_name(line, host)
+                            changed = True
+                
+                if changed:
+                    self._lines = [line for line in self._lines if line.names != []]
+                    self._index()
+                    self._save()
+            except OSError as e:
+                raise SSHManagerError(
+                    f"Failed to update known_hosts: {str(e)}"
+                ) from e
+        return added, replaced
+
+    def remove(self, hosts: Iterable[str], port: int = 22) -> int:
+        """Remove every key of the given hosts.
+        
+        Args:
+            hosts: Host names or addresses
+            port: SSH port
+        
+        Returns:
+            Number of keys removed
+        
+        Raises:
+            SSHManagerError: If the file can't be read or written
+        """
+        entries = {known_hosts_entry(host, port) for host in hosts}
+        with self._lock:
+            try:
+                self._load()
+                removed = 0
+                for host in entries:
+                    for line in self._entries(host):
+                        self._drop_name(line, host)
+                        removed += 1
+                
+                if removed:
+                    self._lines = [line for line in self._lines if line.names != []]
+                    self._index()
+                    self._save()
+            except OSError as e:
+                raise SSHManagerError(
+                    f"Failed to update known_hosts: {str(e)}"
+                ) from e
+        return removed
+
+    def _drop_name(self, line: KnownHostsLine, host: str) -> None:
+        """Remove a host's name, plain or hashed, from an entry; the caller must hold the lock."""
+        self._hashed_matches.pop(host, None)
+        line.names = [
+            name for name in line.names
+            if not (_hashed_entry_matches(name, host) if name.startswith(HASHED_ENTRY_PREFIX)
+                    else name == host)
+        ]
+        line.text = None
@@ -2,36 +2,226 @@
 Logging configuration for the infrastructure automation tool.
 """
 
+import atexit
+import json
 import logging
 import logging.handlers
 import os
+import queue
 import sys
+import threading
+from datetime import datetime, timezone
 from pathlib import Path
-from typing import Optional
+from typing import Any, Dict, Optional
+from python.src.utils.metrics import span_recorder
+
+# Records buffered between application threads and the log writer thread
+DEFAULT_LOG_QUEUE_SIZE = 10000
+# Formats of the log file
+LOG_FORMATS = ('text', 'json')
+
+class EventMessage:
+    """Log message made of an event name and fields, rendered only when emitted."""
+    
+    __slots__ = ('event', 'fields')
+    
+    def __init__(self, event: str, fields: Dict[str, Any]):
+        self.event = event
+        self.fields = fields
+    
+    def __str__(self) -> str:
+        if not self.fields:
+            return self.event
+        rendered = ' '.join(f"{key}={value}" for key, value in self.fields.items())
+        return f"{self.event}: {rendered}"
+
+def log_event(logger: logging.Logger, level: int, event: str, **fields: Any) -> None:
+    """Log an event with structured fields.
+    
+    Nothing is built when the level is disabled, and the fields are only
+    rendered by the formatter, as "event: key=value ..." in text logs or as
+    top-level keys in JSON logs.
+    
+    Args:
+        logger: Logger instance
+        level: Logging level
+        event: Short, constant description of what happened
+        **fields: Values describing this occurrence
+    """
+    if logger.isEnabledFor(level):
+        logger.log(level, EventMessage(event, fields), extra={'fields': fields}, stacklevel=2)
+
+class JSONFormatter(logging.Formatter):
+    """Format records as one JSON object per line."""
+    
+    def format(self, record: logging.LogRecord) -> str:
+        """Render a record with its structured fields as JSON."""
+        if isinstance(record.msg, EventMessage):
+            message = record.msg.event
+        else:
+            message = record.getMessage()
+        timestamp = datetime.fromtimestamp(record.created, timezone.utc)
+        entry: Dict[str, Any] = {
+            'timestamp': timestamp.isoformat(timespec='milliseconds'),
+            'level': record.levelname,
+            'logger': record.name,
+            'message': message,
+        }
+        for key, value in (getattr(record, 'fields', None) or {}).items():
+            entry.setdefault(key, value)
+        if record.exc_info:
+            entry['exception'] = self.formatException(record.exc_info)
+        return json.dumps(entry, default=str)
+
+class DroppingQueueHandler(logging.handlers.QueueHandler):
+    """Queue handler that never blocks callers on low-priority records.
+    
+    When the queue is full, records below drop_level are dropped and
+    counted; records at or above it wait for space so warnings and errors
+    are never lost. Records are queued unformatted: formatting happens on
+    the listener thread.
+    """
+    
+    def __init__(self, log_queue: queue.Queue, drop_level: int = logging.WARNING):
+        """Initialize the handler.
+        
+        Args:
+            log_queue: Bounded queue read by a QueueListener
+            drop_level: Lowest level that is never dropped
+        """
+        super().__init__(log_queue)
+        self.drop_level = drop_level
+        self._stats_lock = threading.Lock()
+        self.enqueued = 0
+        self.dropped: Dict[str, int] = {}
+        self.high_water = 0
+    
+    def prepare(self, record: logging.LogRecord) -> logging.LogRecord:
+        """Queue the record as is; the listener's handlers format it."""
+        return record
+    
+    def enqueue(self, record: logging.LogRecord) -> None:
+        """Put a record on the queue, dropping it if the queue is full and it is low priority."""
+        try:
+            if record.levelno >= self.drop_level:
+                self.queue.put(record)
+            else:
+                self.queue.put_nowait(record)
+        except queue.Full:
+            with self._stats_lock:
+                self.dropped[record.levelname] = self.dropped.get(record.levelname, 0) + 1
+            return
+        
+        depth = self.queue.qsize()
+        with self._stats_lock:
+            self.enqueued += 1
+            if depth > self.high_water:
+                self.high_water = depth
+    
+    def stats(self) -> Dict[str, object]:
+        """Get queue metrics.
+        
+        Returns:
+            Dictionary with enqueued and dropped record counts, current
+            queue depth, highest depth seen and queue capacity
+        """
+        with self._stats_lock:
+            return {
+                'enqueued': self.enqueued,
+                'dropped': sum(self.dropped.values()),
+                'dropped_by_level': dict(self.dropped),
+                'queue_depth': self.queue.qsize(),
+                'high_water': self.high_water,
+                'capacity': self.queue.maxsize,
+            }
+
+class BlockingQueueListener(logging.handlers.QueueListener):
+    """Queue listener that waits for space for its stop sentinel.
+    
+    QueueListener.stop puts the sentinel with put_nowait, which raises
+    queue.Full on a saturated bounded queue and leaves the thread running.
+    """
+    
+    def enqueue_sentinel(self) -> None:
+        """Put the stop sentinel, waiting for the listener to make room."""
+        self.queue.put(self._sentinel)
+
+_queue_handler: Optional[DroppingQueueHandler] = None
+_queue_listener: Optional[BlockingQueueListener] = None
+
+def shutdown_logging() -> None:
+    """Flush queued records and stop the log writer thread, if one is running."""
+    global _queue_handler, _queue_listener
+    if _queue_listener is None:
+        return
+    
+    # Stop queueing first so nothing competes with the sentinel for space
+    logging.getLogger().removeHandler(_queue_handler)
+    _queue_listener.stop()
+    stats = _queue_handler.stats()
+    for handler in _queue_listener.handlers:
+        handler.close()
+    _queue_handler = _queue_listener = None
+    if stats['dropped']:
+        sys.stderr.write(
+            f"WARNING: dropped {stats['dropped']} log records "
+            f"({stats['dropped_by_level']}) because the log queue was full\n"
+        )
+
+def get_log_queue_stats() -> Optional[Dict[str, object]]:
+    """Get metrics of the log queue.
+    
+    Returns:
+        Queue metrics, or None if logging is not queued
+    """
+    return _queue_handler.stats() if _queue_handler is not None else None
 
 def setup_logging(
     log_file: str = "infra_automation.log",
     log_level: int = logging.INFO,
     max_bytes: int = 10 * 1024 * 1024,  # 10MB
-    backup_count: int = 5
+    backup_count: int = 5,
+    use_queue: bool = False,
+    queue_size: int = DEFAULT_LOG_QUEUE_SIZE,
+    drop_level: int = logging.WARNING,
+    log_format: str = 'text'
 ) -> None:
     """Configure logging for the application.
     
+    With use_queue, application threads only put records on a bounded queue
+    and a background QueueListener thread formats them and writes the file
+    and console output. When the queue is full, records below drop_level
+    are dropped and counted (see get_log_queue_stats).
+    
     Args:
         log_file: Path to the log file
         log_level: Logging level
         max_bytes: Maximum size of log file before rotation
         backup_count: Number of backup log files to keep
+        use_queue: Write log output on a background thread
+        queue_size: Maximum number of records waiting to be written
+        drop_level: Lowest level that is never dropped from a full queue
+        log_format: Log file format, 'text' or 'json' (one object per line)
+        
+    Raises:
+        ValueError: If log_format is not supported
     """
+    global _queue_handler, _queue_listener
     # Create logs directory if it doesn't exist
     log_dir = os.path.dirname(log_file)
     if log_dir:
         os.makedirs(log_dir, exist_ok=True)
     
+    if log_format not in LOG_FORMATS:
+        raise ValueError(f"Unsupported log format: {log_format}")
+    
     # Create formatters
-    file_formatter = logging.Formatter(
-        '%(asctime)s - %(name)s - %(levelname)s - %(message)s'
-    )
+    if log_format == 'json':
+        file_formatter = JSONFormatter()
+    else:
+        file_formatter = logging.Formatter(
+            '%(asctime)s - %(name)s - %(levelname)s - %(message)s'
+        )
     console_formatter = logging.Formatter(
         '%(levelname)s: %(message)s'
     )
@@ -51,14 +241,28 @@ def setup_logging(
     # Configure root logger
     root_logger = logging.getLogger()
     root_logger.setLevel(log_level)
-    root_logger.addHandler(file_handler)
-    root_logger.addHandler(console_handler)
+    if use_queue:
+        shutdown_logging()
+        _queue_handler = DroppingQueueHandler(queue.Queue(maxsize=queue_size), drop_level)
+        _queue_listener = BlockingQueueListener(
+            _queue_handler.queue,
+            file_handler,
+            console_handler,
+            respect_handler_level=True
+        )
+        _queue_listener.start()
+        root_logger.addHandler(_queue_handler)
+    else:
+        root_logger.addHandler(file_handler)
+        root_logger.addHandler(console_handler)
     
     # Set specific log levels for third-party libraries
     logging.getLogger('boto3').setLevel(logging.WARNING)
     logging.getLogger('botocore').setLevel(logging.WARNING)
     logging.getLogger('urllib3').setLevel(logging.WARNING)
 
+atexit.register(shutdown_logging)
+
 def get_logger(name: str) -> logging.Logger:
     """Get a logger instance with the specified name.
     
@@ -71,36 +275,51 @@ def get_logger(name: str) -> logging.Logger:
     return logging.getLogger(name)
 
 class LoggingContextManager:
-    """Context manager for logging operations with timing."""
+    """Context manager for logging operations with timing.
     
-    def __init__(self, logger: logging.Logger, operation: str):
+    Each operation is also recorded as a span in src.utils.metrics, nested in
+    the span that is open when it starts, so its duration shows up in the
+    exported per-operation metrics.
+    """
+    
+    def __init__(self, logger: logging.Logger, operation: str, span: Optional[str] = None):
         """Initialize the logging context manager.
         
         Args:
             logger: Logger instance
             operation: Name of the operation being logged
+            span: Stable metrics name of the operation (defaults to operation);
+                set it when operation contains host names or counts
         """
         self.logger = logger
         self.operation = operation
-        self.start_time = None
+        self.span_name = span or operation
+        self.span = None
+        self._token = None
+    
+    @property
+    def duration(self) -> float:
+        """Seconds elapsed since the operation started."""
+        return self.span.duration if self.span is not None else 0.0
     
     def __enter__(self) -> 'LoggingContextManager':
         """Enter the context and log the start of the operation."""
-        self.start_time = logging.time.time()
         self.logger.info(f"Starting {self.operation}")
+        self.span, self._token = span_recorder.start(self.span_name)
         return self
     
     def __exit__(self, exc_type, exc_val, exc_tb) -> None:
         """Exit the context and log the completion or failure of the operation."""
-        duration = logging.time.time() - self.start_time
+        span_recorder.finish(self.span, self._token, failed=exc_type is not None)
+        duration = self.span.duration
         
         if exc_type is None:
             self.logger.info(
-                f"Completed {self.operation} in {duration:.2f} seconds"
+                f"Completed {self.operation} in {duration:.3f} seconds"
             )
         else:
             self.logger.error(
-                f"Failed {self.operation} after {duration:.2f} seconds",
+                f"Failed {self.operation} after {duration:.3f} seconds",
                 exc_info=(exc_type, exc_val, exc_tb)
             )
 
@@ -119,5 +338,5 @@ def log_sensitive_data(logger: logging.Logger, data: str) -> str:
     
     # Mask all but last 4 characters
     masked = '*' * (len(data) - 4) + data[-4:]
-    logger.debug(f"Masked sensitive data: {masked}")
+    logger.debug("Masked sensitive data: %s", masked)
     return masked 
\ No newline at end of file
@@ -0,0 +1,263 @@
+"""
+Timing Spans and Metrics Export
+
+This module times operations as nested spans and aggregates their durations
+per span name and parent span, so a run can be broken down into describe,
+serialize and SSH time. Durations are measured with perf_counter_ns. The
+aggregates can be written as a Prometheus textfile (for the node_exporter
+textfile collector) or as OpenMetrics text, for example at process exit.
+"""
+
+import atexit
+import contextvars
+import math
+import os
+import random
+import sys
+import tempfile
+import threading
+import time
+from concurrent.futures import Executor, Future
+from contextlib import contextmanager
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple
+
+# Durations kept per series for percentiles; older samples are replaced at
+# random (reservoir sampling) once a series has more
+MAX_SAMPLES = 4096
+# Metric name prefix
+METRIC_PREFIX = "infra_automation_span"
+# Export formats
+EXPORT_FORMATS = ('prometheus', 'openmetrics')
+
+class SpanStats:
+    """Duration statistics of one span series."""
+    
+    def __init__(self):
+        """Initialize empty statistics."""
+        self.count = 0
+        self.errors = 0
+        self.total_ns = 0
+        self.max_ns = 0
+        self.samples: List[int] = []
+    
+    def add(self, duration_ns: int, failed: bool) -> None:
+        """Record one span duration."""
+        self.count += 1
+        self.errors += failed
+        self.total_ns += duration_ns
+        self.max_ns = max(self.max_ns, duration_ns)
+        if len(self.samples) < MAX_SAMPLES:
+            self.samples.append(duration_ns)
+        else:
+            index = random.randrange(self.count)
+            if index < MAX_SAMPLES:
+                self.samples[index] = duration_ns
+    
+    def quantile(self, q: float) -> float:
+        """Get a duration quantile in seconds (nearest rank)."""
+        if not self.samples:
+            return 0.0
+        ordered = sorted(self.samples)
+        index = min(len(ordered) - 1, max(0, math.ceil(q * len(ordered)) - 1))
+        return ordered[index] / 1e9
+    
+    def summary(self) -> Dict[str, float]:
+        """Get count, errors, p50, p95, max and total in seconds."""
+        return {
+            'count': self.count,
+            'errors': self.errors,
+            'p50': self.quantile(0.5),
+            'p95': self.quantile(0.95),
+            'max': self.max_ns / 1e9,
+            'sum': self.total_ns / 1e9,
+        }
+
+class Span:
+    """A timed operation, possibly nested in a parent span."""
+    
+    __slots__ = ('name', 'parent', 'start_ns', 'duration_ns')
+    
+    def __init__(self, name: str, parent: Optional['Span']):
+        self.name = name
+        self.parent = parent
+        self.start_ns = time.perf_counter_ns()
+        self.duration_ns: Optional[int] = None
+    
+    @property
+    def duration(self) -> float:
+        """Duration in seconds, or the time elapsed so far for an open span."""
+        end_ns = self.start_ns + self.duration_ns if self.duration_ns is not None \
+            else time.perf_counter_ns()
+        return (end_ns - self.start_ns) / 1e9
+
+# Innermost open span of the current thread or task
+_current_span: contextvars.ContextVar[Optional[Span]] = contextvars.ContextVar(
+    'current_span', default=None
+)
+
+class SpanRecorder:
+    """Thread-safe aggregation of span durations by (name, parent name)."""
+    
+    def __init__(self):
+        """Initialize an empty recorder."""
+        self._lock = threading.Lock()
+        self._series: Dict[Tuple[str, str], SpanStats] = {}
+    
+    def start(self, name: str) -> Tuple[Span, contextvars.Token]:
+        """Open a span as a child of the current span."""
+        span = Span(name, _current_span.get())
+        return span, _current_span.set(span)
+    
+    def finish(self, span: Span, token: contextvars.Token, failed: bool = False) -> None:
+        """Close a span and record its duration."""
+        span.duration_ns = time.perf_counter_ns() - span.start_ns
+        _current_span.reset(token)
+        parent = span.parent.name if span.parent is not None else ""
+        with self._lock:
+            stats = self._series.get((span.name, parent))
+            if stats is None:
+                stats = self._series[(span.name, parent)] = SpanStats()
+            stats.add(span.duration_ns, failed)
+    
+    @contextmanager
+    def span(self, name: str) -> Iterator[Span]:
+        """Time a block as a span nested in the current span.
+        
+        Args:
+            name: Span name; use a constant such as "aws.describe_instances",
+                not a string containing host names or IDs
+        """
+        span, token = self.start(name)
+        failed = True
+        try:
+            yield span
+            failed = False
+        finally:
+            self.finish(span, token, failed)
+    
+    def snapshot(self) -> Dict[Tuple[str, str], Dict[str, float]]:
+        """Get the summary of every series, keyed by (name, parent name)."""
+        with self._lock:
+            return {key: stats.summary() for key, stats in sorted(self._series.items())}
+    
+    def clear(self) -> None:
+        """Drop all recorded spans."""
+        with self._lock:
+            self._series.clear()
+    
+    def render(self, export_format: str = 'prometheus') -> str:
+        """Render the recorded spans in Prometheus or OpenMetrics text format.
+        
+        Raises:
+            ValueError: If the format is not supported
+        """
+        if export_format not in EXPORT_FORMATS:
+            raise ValueError(f"Unsupported metrics format: {export_format}")
+        
+        duration = f"{METRIC_PREFIX}_duration_seconds"
+        lines = [
+            f"# HELP {duration} Duration of timed operations.",
+            f"# TYPE {duration} summary",
+        ]
+        if export_format == 'openmetrics':
+            lines.append(f"# UNIT {duration} seconds")
+        series = self.snapshot()
+        for (name, parent), summary in series.items():
+            labels = f'span="{_escape(name)}",parent="{_escape(parent)}"'
+            lines.append(f'{duration}{{{labels},quantile="0.5"}} {summary["p50"]:.9f}')
+            lines.append(f'{duration}{{{labels},quantile="0.95"}} {summary["p95"]:.9f}')
+            lines.append(f'{duration}_sum{{{labels}}} {summary["sum"]:.9f}')
+            lines.append(f'{duration}_count{{{labels}}} {summary["count"]}')
+        
+        longest = f"{METRIC_PREFIX}_max_seconds"
+        lines.append(f"# HELP {longest} Longest duration of timed operations.")
+        lines.append(f"# TYPE {longest} gauge")
+        if export_format == 'openmetrics':
+            lines.append(f"# UNIT {longest} seconds")
+        for (name, parent), summary in series.items():
+            labels = f'span="{_escape(name)}",parent="{_escape(parent)}"'
+            lines.append(f'{longest}{{{labels}}} {summary["max"]:.9f}')
+        
+        # Errors only ever grow, so they are a counter; OpenMetrics names the
+        # family without the _total suffix of its samples
+        errors = f"{METRIC_PREFIX}_errors"
+        family = errors if export_format == 'openmetrics' else f"{errors}_total"
+        lines.append(f"# HELP {family} Timed operations that raised an exception.")
+        lines.append(f"# TYPE {family} counter")
+        for (name, parent), summary in series.items():
+            labels = f'span="{_escape(name)}",parent="{_escape(parent)}"'
+            lines.append(f'{errors}_total{{{labels}}} {summary["errors"]}')
+        
+        if export_format == 'openmetrics':
+            lines.append("# EOF")
+        return "\n".join(lines) + "\n"
+    
+    def export(self, path: str, export_format: str = 'prometheus') -> None:
+        """Atomically write the recorded spans to a textfile.
+        
+        Args:
+            path: Output file, e.g. in the node_exporter textfile directory
+            export_format: 'prometheus' or 'openmetrics'
+        """
+        content = self.render(export_format)
+        directory = os.path.dirname(os.path.abspath(path))
+        os.makedirs(directory, exist_ok=True)
+        fd, temp_path = tempfile.mkstemp(dir=directory, prefix=f".{os.path.basename(path)}.")
+        try:
+            with os.fdopen(fd, 'w') as f:
+                f.write(content)
+            os.chmod(temp_path, 0o644)
+            os.replace(temp_path, path)
+        except OSError:
+            try:
+                os.unlink(temp_path)
+            except OSError:
+                pass
+            raise
+
+def _escape(value: str) -> str:
+    """Escape a Prometheus label value."""
+    return value.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n')
+
+def current_span() -> Optional[Span]:
+    """Get the innermost open span of the current thread or task."""
+    return _current_span.get()
+
+def submit_in_context(executor: Executor, fn: Callable[..., Any], *args: Any,
+                      **kwargs: Any) -> Future:
+    """Submit a call to an executor in a copy of the current context.
+    
+    Pool threads don't inherit the submitter's context variables, so spans
+    opened by the call would otherwise have no parent. With the copy they
+    nest under the span that is open where the call was submitted.
+    """
+    return executor.submit(contextvars.copy_context().run, fn, *args, **kwargs)
+
+# Process-wide recorder used by LoggingContextManager and span()
+span_recorder = SpanRecorder()
+
+def span(name: str):
+    """Time a block as a span on the process-wide recorder, without logging."""
+    return span_recorder.span(name)
+
+def export_metrics_at_exit(path: str, export_format: str = 'prometheus') -> None:
+    """Write the process-wide spans to a textfile when the process exits.
+    
+    Args:
+        path: Output file
+        export_format: 'prometheus' or 'openmetrics'
+    
+    Raises:
+        ValueError: If the format is not supported
+    """
+    if export_format not in EXPORT_FORMATS:
+        raise ValueError(f"Unsupported metrics format: {export_format}")
+    
+    def export() -> None:
+        try:
+            span_recorder.export(path, export_format)
+        except OSError as e:
+            # Logging may already be shut down at this point
+            print(f"WARNING: failed to write metrics to {path}: {e}", file=sys.stderr)
+    
+    atexit.register(export)
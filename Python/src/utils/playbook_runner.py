@@ -0,0 +1,571 @@
+"""
+Parallel Playbook Runner
+
+This module runs Ansible playbooks through ansible-runner. Several playbook
+and inventory pairs, e.g. one per environment, run concurrently under a
+bounded worker pool instead of one ansible-playbook process after another.
+Each run gets its own private data directory and its per-host results are
+streamed back through an event callback while the run is in progress.
+"""
+
+import os
+import json
+import shlex
+import time
+import shutil
+import logging
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional, Union
+from python.src.utils.exceptions import PlaybookError, ValidationError
+from python.src.utils.logging_config import get_logger, log_event, LoggingContextManager
+from python.src.utils.metrics import span, submit_in_context
+
+logger = get_logger(__name__)
+
+# Playbook runs executed at the same time
+DEFAULT_PLAYBOOK_WORKERS = 4
+# ansible-runner event names and the host status they report
+HOST_EVENT_STATUSES = {
+    'runner_on_ok': 'ok',
+    'runner_on_failed': 'failed',
+    'runner_on_unreachable': 'unreachable',
+    'runner_on_skipped': 'skipped',
+}
+# Execution strategies accepted for a run
+STRATEGIES = ('linear', 'free', 'host_pinned')
+# Ansible's own default number of forks
+ANSIBLE_DEFAULT_FORKS = 5
+# Upper bound of the fleet-size-based default number of forks
+MAX_DEFAULT_FORKS = 50
+# Fleets larger than this are rolled out in batches by default
+ROLLING_FLEET_SIZE = 100
+# Default batches of a rolling rollout: a canary batch, then all remaining hosts
+DEFAULT_ROLLING_SERIAL = ['5%', '100%']
+# sudo errors on hosts whose sudoers requires a tty
+REQUIRETTY_MESSAGES = ("must have a tty", "no tty present")
+# Log level of each host status
+HOST_STATUS_LEVELS = {
+    'ok': logging.DEBUG,
+    'skipped': logging.DEBUG,
+    'changed': logging.INFO,
+    'failed': logging.ERROR,
+    'unreachable': logging.ERROR,
+}
+
+@dataclass
+class ExecutionOptions:
+    """How a run spreads over the hosts; None keeps Ansible's default.
+    
+    serial and throttle are passed to the playbook as the rollout_serial and
+    rollout_throttle variables, which webserver.yml uses as its play's
+    serial and its package tasks' throttle. gather_subset is passed as
+    facts_gather_subset, replacing the play's narrowed fact subsets; facts
+    are then gathered even on hosts with cached facts, which were gathered
+    with the narrowed subsets.
+    """
+    strategy: Optional[str] = None
+    forks: Optional[int] = None
+    serial: Optional[List[Union[int, str]]] = None
+    throttle: Optional[int] = None
+    gather_subset: Optional[List[str]] = None
+    
+    def with_defaults(self, host_count: Optional[int]) -> 'ExecutionOptions':
+        """Fill the unset options with defaults for a fleet size.
+        
+        Forks grow with the fleet up to MAX_DEFAULT_FORKS. The strategy stays
+        linear, since host_pinned and free change the order of handlers and
+        failures; a fleet that doesn't fit in one round of forks only logs a
+        suggestion to use them. Fleets over ROLLING_FLEET_SIZE hosts are
+        rolled out as a canary batch followed by the remaining hosts.
+        
+        Args:
+            host_count: Number of hosts in the run, or None if unknown
+        
+        Returns:
+            Options with defaults applied; unchanged if host_count is None
+        """
+        if host_count is None:
+            return self
+        forks = self.forks or min(MAX_DEFAULT_FORKS, max(ANSIBLE_DEFAULT_FORKS, host_count))
+        if self.strategy is None and host_count > forks:
+            logger.info(f"{host_count} hosts don't fit in one round of {forks} forks; "
+                        f"--strategy host_pinned or free lets a fork move on to the next "
+                        f"host instead of waiting for the slowest host at every task")
+        strategy = self.strategy or 'linear'
+        serial = self.serial
+        if serial is None and host_count > ROLLING_FLEET_SIZE:
+            serial = list(DEFAULT_ROLLING_SERIAL)
+        return ExecutionOptions(strategy, forks, serial, self.throttle, self.gather_subset)
+    
+    def envvars(self) -> Dict[str, str]:
+        """Environment variables of the ansible-playbook process."""
+        envvars: Dict[str, str] = {}
+        if self.strategy:
+            envvars['ANSIBLE_STRATEGY'] = self.strategy
+        if self.gather_subset is not None:
+            # Overrides the generated config's smart gathering
+            envvars['ANSIBLE_GATHERING'] = 'implicit'
+        return envvars
+    
+    def extra_vars(self) -> Dict[str, Any]:
+        """Variables read by the playbook."""
+        extra_vars: Dict[str, Any] = {}
+        if self.serial is not None:
+            extra_vars['rollout_serial'] = self.serial
+        if self.throttle is not None:
+            extra_vars['rollout_throttle'] = self.throttle
+        if self.gather_subset is not None:
+            extra_vars['facts_gather_subset'] = self.gather_subset
+        return extra_vars
+    
+    def runner_options(self) -> Dict[str, Any]:
+        """ansible_runner.run arguments."""
+        return {'forks': self.forks} if self.forks else {}
+
+@dataclass
+class PlaybookRun:
+    """A playbook to run against an inventory."""
+    playbook: str
+    inventory: str
+    limit: Optional[List[str]] = None
+    extra_vars: Dict[str, Any] = field(default_factory=dict)
+    execution: ExecutionOptions = field(default_factory=ExecutionOptions)
+    
+    @property
+    def label(self) -> str:
+        """Name of the run in logs and events."""
+        return f"{os.path.basename(self.playbook)}@{self.inventory}"
+
+@dataclass
+class HostEvent:
+    """Result of one task on one host, reported while a run is in progress."""
+    run: str
+    host: str
+    task: str
+    status: str
+
+@dataclass
+class BatchTiming:
+    """Wall time of one serial batch of a play."""
+    play: str
+    hosts: int
+    elapsed: float
+
+@dataclass
+class PlaybookResult:
+    """Outcome of a playbook run."""
+    run: PlaybookRun
+    status: str
+    rc: int
+    elapsed: float
+    stats: Dict[str, Dict[str, int]] = field(default_factory=dict)
+    error: Optional[str] = None
+    batches: List[BatchTiming] = field(default_factory=list)
+    
+    @property
+    def success(self) -> bool:
+        """Whether the run completed without failed or unreachable hosts."""
+        return self.status == 'successful' and self.rc == 0
+    
+    @property
+    def failed_hosts(self) -> List[str]:
+        """Hosts with failed tasks or that were unreachable."""
+        return sorted(set(self.stats.get('failures', {})) | set(self.stats.get('dark', {})))
+
+def _load_ansible_runner() -> Any:
+    """Import ansible-runner.
+    
+    Raises:
+        PlaybookError: If ansible-runner is not installed
+    """
+    try:
+        import ansible_runner
+    except ImportError as e:
+        raise PlaybookError(
+            "Running playbooks requires ansible-runner: pip install ansible-runner"
+        ) from e
+    return ansible_runner
+
+def parse_extra_vars(values: Optional[List[str]]) -> Dict[str, Any]:
+    """Parse --extra-vars arguments.
+    
+    Args:
+        values: Space-separated KEY=VALUE pairs, as ansible-playbook accepts
+            them, and JSON objects; later values win
+    
+    Returns:
+        Dictionary of extra variables
+    
+    Raises:
+        ValidationError: If a value is neither KEY=VALUE nor a JSON object
+    """
+    extra_vars: Dict[str, Any] = {}
+    for value in values or []:
+        if value.lstrip().startswith('{'):
+            try:
+                parsed = json.loads(value)
+            except ValueError as e:
+                raise ValidationError(f"Invalid extra vars JSON: {str(e)}") from e
+            if not isinstance(parsed, dict):
+                raise ValidationError(f"Extra vars must be a JSON object: {value}")
+            extra_vars.update(parsed)
+            continue
+        
+        try:
+            pairs = shlex.split(value)
+        except ValueError as e:
+            raise ValidationError(f"Invalid extra vars {value}: {str(e)}") from e
+        for pair in pairs:
+            key, separator, var_value = pair.partition('=')
+            if not separator or not key:
+                raise ValidationError(f"Invalid extra var (expected KEY=VALUE): {pair}")
+            extra_vars[key] = var_value
+    return extra_vars
+
+def parse_serial(value: str) -> List[Union[int, str]]:
+    """Parse a comma-separated list of serial batch sizes.
+    
+    Args:
+        value: Batch sizes as host counts or percentages, e.g. "1,10%,100%"
+    
+    Returns:
+        List of batch sizes as Ansible's serial keyword accepts them
+    
+    Raises:
+        ValidationError: If a batch size is not a positive count or percentage
+    """
+    batches: List[Union[int, str]] = []
+    for item in value.split(','):
+        item = item.strip()
+        number = item[:-1] if item.endswith('%') else item
+        if not number.isdigit() or int(number) == 0 or (item.endswith('%') and int(number) > 100):
+            raise ValidationError(f"Invalid serial batch size: {item}")
+        batches.append(item if item.endswith('%') else int(item))
+    return batches
+
+def playbook_host_groups(path: str) -> Optional[List[str]]:
+    """Get the groups the plays of a playbook run on.
+    
+    Args:
+        path: Playbook path
+    
+    Returns:
+        Group names of every play's hosts, or None if the playbook can't be
+        read or a play targets all hosts or a host pattern
+    """
+    import yaml
+    
+    try:
+        with open(path, 'r') as f:
+            plays = yaml.safe_load(f)
+    except (OSError, yaml.YAMLError):
+        return None
+    if not isinstance(plays, list):
+        return None
+    groups: List[str] = []
+    for play in plays:
+        hosts = play.get('hosts') if isinstance(play, dict) else None
+        if not isinstance(hosts, str):
+            return None
+        for name in hosts.replace(':', ',').split(','):
+            name = name.strip()
+            if not name or name == 'all' or any(char in name for char in '*?!&~[{'):
+                return None
+            groups.append(name)
+    return groups
+
+def count_inventory_hosts(path: str, groups: Optional[List[str]] = None) -> Optional[int]:
+    """Count the hosts of a JSON inventory file.
+    
+    Args:
+        path: Inventory written by the inventory command, in file or
+            dynamic inventory script format
+        groups: Only count the hosts of these groups; all hosts if None
+    
+    Returns:
+        Number of hosts, or None if the inventory is not JSON
+    """
+    try:
+        with open(path, 'r') as f:
+            inventory = json.load(f)
+    except (OSError, ValueError):
+        return None
+    if not isinstance(inventory, dict):
+        return None
+    script_format = '_meta' in inventory
+    if groups is None:
+        if script_format:
+            return len(inventory['_meta'].get('hostvars', {}))
+        return len(inventory.get('all', {}).get('hosts', {}))
+    
+    # Groups are written flat: under all.children in file format and at the
+    # top level in script format
+    group_data = inventory if script_format else inventory.get('all', {}).get('children', {})
+    hosts = set()
+    for group in groups:
+        hosts.update((group_data.get(group) or {}).get('hosts') or ())
+    return len(hosts)
+
+def pair_runs(
+    playbooks: List[str],
+    inventories: List[str],
+    limit: Optional[List[str]] = None,
+    extra_vars: Optional[Dict[str, Any]] = None
+) -> List[PlaybookRun]:
+    """Pair playbooks with inventories.
+    
+    A single playbook runs against every inventory and every playbook runs
+    against a single inventory; otherwise playbooks and inventories are
+    paired by position.
+    
+    Args:
+        playbooks: Playbook paths
+        inventories: Inventory paths
+        limit: Hosts every run is limited to
+        extra_vars: Extra variables of every run
+    
+    Returns:
+        List of playbook runs
+    
+    Raises:
+        ValidationError: If the numbers of playbooks and inventories don't match
+    """
+    if len(playbooks) == 1:
+        playbooks = playbooks * len(inventories)
+    elif len(inventories) == 1:
+        inventories = inventories * len(playbooks)
+    if len(playbooks) != len(inventories):
+        raise ValidationError(
+            f"Cannot pair {len(playbooks)} playbooks with {len(inventories)} inventories"
+        )
+    return [
+        PlaybookRun(playbook, inventory, limit, dict(extra_vars or {}))
+        for playbook, inventory in zip(playbooks, inventories)
+    ]
+
+def log_host_event(event: HostEvent) -> None:
+    """Log a host event; failures at ERROR, changes at INFO, the rest at DEBUG."""
+    log_event(logger, HOST_STATUS_LEVELS.get(event.status, logging.INFO), "Host result",
+              run=event.run, host=event.host, task=event.task, status=event.status)
+
+def _host_event(label: str, event: Dict[str, Any]) -> Optional[HostEvent]:
+    """Convert an ansible-runner event into a host event, if it reports a host result."""
+    status = HOST_EVENT_STATUSES.get(event.get('event'))
+    if status is None:
+        return None
+    data = event.get('event_data', {})
+    if status == 'ok' and data.get('res', {}).get('changed'):
+        status = 'changed'
+    return HostEvent(label, data.get('host', ''), data.get('task', ''), status)
+
+def _fact_cache_options(envvars: Optional[Dict[str, str]]) -> Dict[str, Any]:
+    """Get the ansible_runner.run arguments of a jsonfile fact cache in the environment.
+    
+    ansible-runner sets ANSIBLE_CACHE_PLUGIN_CONNECTION to a directory in the
+    run's artifacts, replacing the environment's, so the cache directory has
+    to be passed as its fact_cache argument to outlive the run.
+    """
+    envvars = envvars or {}
+    if envvars.get('ANSIBLE_CACHE_PLUGIN') != 'jsonfile' \
+            or not envvars.get('ANSIBLE_CACHE_PLUGIN_CONNECTION'):
+        return {}
+    return {
+        'fact_cache': os.path.abspath(envvars['ANSIBLE_CACHE_PLUGIN_CONNECTION']),
+        'fact_cache_type': 'jsonfile',
+    }
+
+def run_playbook(
+    run: PlaybookRun,
+    on_event: Optional[Callable[[HostEvent], None]] = log_host_event,
+    envvars: Optional[Dict[str, str]] = None,
+    **runner_options: Any
+) -> PlaybookResult:
+    """Run a playbook and wait for it to finish.
+    
+    Args:
+        run: Playbook run
+        on_event: Called with each host result as it arrives
+        envvars: Environment variables of the ansible-playbook process; the
+            run's execution options override them
+        **runner_options: Further ansible_runner.run arguments, e.g. forks
+    
+    Returns:
+        PlaybookResult of the run
+    
+    Raises:
+        PlaybookError: If ansible-runner is not installed or the run can't be started
+    """
+    ansible_runner = _load_ansible_runner()
+    batches: List[BatchTiming] = []
+    # Play, start time and hosts of the batch in progress
+    batch: Dict[str, Any] = {}
+    
+    def finish_batch() -> None:
+        if batch:
+            timing = BatchTiming(batch['play'], len(batch['hosts']), time.monotonic() - batch['started'])
+            batches.append(timing)
+            log_event(logger, logging.INFO, "Batch finished", run=run.label, play=timing.play,
+                      batch=len(batches), hosts=timing.hosts, elapsed=round(timing.elapsed, 3))
+            batch.clear()
+    
+    def event_handler(event: Dict[str, Any]) -> bool:
+        # Ansible starts the play again for every serial batch
+        if event.get('event') in ('playbook_on_play_start', 'playbook_on_stats'):
+            finish_batch()
+            if event['event'] == 'playbook_on_play_start':
+                batch.update(play=event.get('event_data', {}).get('play', ''),
+                             started=time.monotonic(), hosts=set())
+        host_event = _host_event(run.label, event)
+        if host_event is not None:
+            if batch:
+                batch['hosts'].add(host_event.host)
+            if on_event is not None:
+                on_event(host_event)
+        # Keep the event in the run's artifacts
+        return True
+    
+    # The run's own options are more specific than the shared settings
+    run_envvars = {**(envvars or {}), **run.execution.envvars()}
+    private_data_dir = tempfile.mkdtemp(prefix="ansible-runner-")
+    started = time.monotonic()
+    try:
+        with span("ansible.playbook"):
+            runner = ansible_runner.run(
+                private_data_dir=private_data_dir,
+                playbook=os.path.abspath(run.playbook),
+                inventory=os.path.abspath(run.inventory),
+                limit=','.join(run.limit) if run.limit else None,
+                extravars={**run.execution.extra_vars(), **run.extra_vars} or None,
+                envvars=run_envvars or None,
+                event_handler=event_handler,
+                quiet=True,
+                **{**_fact_cache_options(run_envvars), **run.execution.runner_options(),
+                   **runner_options}
+            )
+    except Exception as e:
+        raise PlaybookError(f"Failed to run {run.label}: {str(e)}") from e
+    finally:
+        shutil.rmtree(private_data_dir, ignore_errors=True)
+    finish_batch()
+    
+    result = PlaybookResult(
+        run, runner.status, runner.rc, time.monotonic() - started, runner.stats or {},
+        batches=batches
+    )
+    log_event(
+        logger, logging.INFO if result.success else logging.ERROR, "Playbook run finished",
+        run=run.label, status=result.status, rc=result.rc, elapsed=round(result.elapsed, 3),
+        batches=[round(timing.elapsed, 3) for timing in batches],
+        **{key: len(result.stats.get(key, {})) for key in ('ok', 'changed', 'failures', 'dark')}
+    )
+    return result
+
+def run_playbooks(
+    runs: List[PlaybookRun],
+    max_workers: int = DEFAULT_PLAYBOOK_WORKERS,
+    on_event: Optional[Callable[[HostEvent], None]] = log_host_event,
+    envvars: Optional[Dict[str, str]] = None,
+    **runner_options: Any
+) -> List[PlaybookResult]:
+    """Run several playbooks concurrently.
+    
+    A run that can't be started is reported as a result with status 'error'
+    rather than stopping the other runs.
+    
+    Args:
+        runs: Playbook runs
+        max_workers: Maximum number of runs at the same time
+        on_event: Called with each host result as it arrives, from the
+            thread of the run that produced it
+        envvars: Environment variables of the ansible-playbook processes
+        **runner_options: Further ansible_runner.run arguments, e.g. forks
+    
+    Returns:
+        List of PlaybookResult in the order of runs
+    
+    Raises:
+        PlaybookError: If ansible-runner is not installed
+    """
+    _load_ansible_runner()
+    
+    def run_one(run: PlaybookRun) -> PlaybookResult:
+        started = time.monotonic()
+        try:
+            return run_playbook(run, on_event, envvars, **runner_options)
+        except PlaybookError as e:
+            logger.error(str(e))
+            return PlaybookResult(run, 'error', -1, time.monotonic() - started, error=str(e))
+    
+    with LoggingContextManager(logger, f"running {len(runs)} playbooks",
+                               span="ansible.run_playbooks"):
+        with ThreadPoolExecutor(max_workers=max(1, min(max_workers, len(runs) or 1))) as executor:
+            futures = [submit_in_context(executor, run_one, run) for run in runs]
+            return [future.result() for future in futures]
+
+def check_pipelining(
+    inventory: str,
+    envvars: Optional[Dict[str, str]] = None,
+    limit: Optional[List[str]] = None,
+    **runner_options: Any
+) -> Dict[str, str]:
+    """Run a command with become on every host to verify that pipelining works.
+    
+    With pipelining, modules are fed to sudo over stdin without a tty, which
+    fails on hosts whose sudoers sets requiretty.
+    
+    Args:
+        inventory: Inventory path
+        envvars: Environment of the ansible process, e.g. Ansible settings
+            with pipelining enabled
+        limit: Hosts to check
+        **runner_options: Further ansible_runner.run arguments, e.g. forks
+    
+    Returns:
+        Dictionary of host to 'ok', 'requiretty', 'failed' or 'unreachable'
+    
+    Raises:
+        PlaybookError: If ansible-runner is not installed or the check can't be started
+    """
+    ansible_runner = _load_ansible_runner()
+    results: Dict[str, str] = {}
+    
+    def event_handler(event: Dict[str, Any]) -> bool:
+        status = HOST_EVENT_STATUSES.get(event.get('event'))
+        if status is None:
+            return True
+        data = event.get('event_data', {})
+        if status == 'failed':
+            res = data.get('res', {})
+            message = ' '.join(str(res.get(key, '')) for key in ('msg', 'module_stderr', 'stderr'))
+            if any(marker in message for marker in REQUIRETTY_MESSAGES):
+                status = 'requiretty'
+        results[data.get('host', '')] = status
+        return True
+    
+    private_data_dir = tempfile.mkdtemp(prefix="ansible-runner-")
+    try:
+        with span("ansible.check_pipelining"):
+            ansible_runner.run(
+                private_data_dir=private_data_dir,
+                inventory=os.path.abspath(inventory),
+                host_pattern='all',
+                module='command',
+                module_args='true',
+                cmdline='--become',
+                limit=','.join(limit) if limit else None,
+                envvars=envvars,
+                event_handler=event_handler,
+                quiet=True,
+                **{**_fact_cache_options(envvars), **runner_options}
+            )
+    except Exception as e:
+        raise PlaybookError(f"Failed to check pipelining on {inventory}: {str(e)}") from e
+    finally:
+        shutil.rmtree(private_data_dir, ignore_errors=True)
+    
+    for host, status in sorted(results.items()):
+        log_event(logger, logging.INFO if status == 'ok' else logging.ERROR,
+                  "Pipelining check", host=host, status=status)
+    return results
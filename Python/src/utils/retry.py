@@ -0,0 +1,182 @@
+"""
+Retry and Rate Limiting for AWS API Calls
+
+This module provides an adaptive client-side token bucket and a retry helper
+with jittered exponential backoff. A bucket shared by concurrent workers keeps
+their combined request rate close to what the account allows: the rate is
+halved whenever a call is throttled and grows back slowly while calls succeed.
+"""
+
+import logging
+import random
+import threading
+import time
+from typing import Any, Callable, Optional
+from botocore.exceptions import ClientError, ConnectionClosedError, EndpointConnectionError
+from python.src.utils.logging_config import get_logger, log_event
+
+logger = get_logger(__name__)
+
+# Error codes returned when the API rate limit is exceeded
+THROTTLING_ERROR_CODES = frozenset({
+    'RequestLimitExceeded',
+    'Throttling',
+    'ThrottlingException',
+    'TooManyRequestsException',
+    'RequestThrottled',
+    'SlowDown'
+})
+
+# Error codes of transient server-side failures
+TRANSIENT_ERROR_CODES = frozenset({
+    'InternalError',
+    'InternalFailure',
+    'ServiceUnavailable',
+    'Unavailable'
+})
+
+# Default retry settings
+DEFAULT_MAX_ATTEMPTS = 8
+DEFAULT_BASE_DELAY = 0.25
+DEFAULT_MAX_DELAY = 20.0
+
+class TokenBucket:
+    """Adaptive token bucket limiting the rate of API calls.
+    
+    Tokens are refilled continuously at the current rate, up to a burst
+    capacity. The rate is cut multiplicatively on throttling and raised
+    additively on success (AIMD), between a minimum and maximum rate.
+    """
+
+    def __init__(
+        self,
+        rate: float = 20.0,
+        capacity: float = 20.0,
+        min_rate: float = 0.5,
+        max_rate: float = 100.0,
+        increase: float = 0.5,
+        decrease_factor: float = 0.5
+    ):
+        """Initialize the token bucket.
+        
+        Args:
+            rate: Initial rate in calls per second
+            capacity: Maximum number of tokens (burst size)
+            min_rate: Lowest rate reached by throttling
+            max_rate: Highest rate reached by successful calls
+            increase: Rate increase per successful call
+            decrease_factor: Rate multiplier applied on throttling
+        """
+        self.rate = rate
+        self.capacity = capacity
+        self.min_rate = min_rate
+        self.max_rate = max_rate
+        self.increase = increase
+        self.decrease_factor = decrease_factor
+        self._tokens = min(capacity, rate)
+        self._updated = time.monotonic()
+        self._lock = threading.Lock()
+
+    def _refill(self, now: float) -> None:
+        """Add the tokens accrued since the last update; the caller must hold the lock."""
+        self._tokens = min(self.capacity, self._tokens + (now - self._updated) * self.rate)
+        self._updated = now
+
+    def acquire(self) -> float:
+        """Take one token, waiting until one is available.
+        
+        Returns:
+            Seconds spent waiting
+        """
+        waited = 0.0
+        while True:
+            with self._lock:
+                self._refill(time.monotonic())
+                if self._tokens >= 1:
+                    self._tokens -= 1
+                    return waited
+                delay = (1 - self._tokens) / self.rate
+            time.sleep(delay)
+            waited += delay
+
+    def on_success(self) -> None:
+        """Raise the rate after a successful call."""
+        with self._lock:
+            self.rate = min(self.max_rate, self.rate + self.increase)
+
+    def on_throttle(self) -> None:
+        """Cut the rate and drain the bucket after a throttled call."""
+        with self._lock:
+            self._refill(time.monotonic())
+            self.rate = max(self.min_rate, self.rate * self.decrease_factor)
+            self._tokens = min(self._tokens, 0.0)
+            logger.warning(f"API calls throttled, reducing request rate to {self.rate:.2f}/s")
+
+def backoff_delay(attempt: int, base_delay: float, max_delay: float) -> float:
+    """Get a jittered exponential backoff delay ("full jitter").
+    
+    Args:
+        attempt: Number of the failed attempt, starting at 1
+        base_delay: Delay cap of the first retry in seconds
+        max_delay: Maximum delay cap in seconds
+        
+    Returns:
+        Random delay between zero and the capped exponential delay
+    """
+    return random.uniform(0, min(max_delay, base_delay * (2 ** (attempt - 1))))
+
+def call_with_retry(
+    func: Callable[..., Any],
+    *args,
+    limiter: Optional[TokenBucket] = None,
+    max_attempts: int = DEFAULT_MAX_ATTEMPTS,
+    base_delay: float = DEFAULT_BASE_DELAY,
+    max_delay: float = DEFAULT_MAX_DELAY,
+    **kwargs
+) -> Any:
+    """Call an AWS API function, retrying throttled and transient failures.
+    
+    Args:
+        func: Client method to call
+        *args: Positional arguments for func
+        limiter: Optional token bucket shared with other callers
+        max_attempts: Maximum number of attempts
+        base_delay: Backoff delay cap of the first retry in seconds
+        max_delay: Maximum backoff delay cap in seconds
+        **kwargs: Keyword arguments for func
+        
+    Returns:
+        Result of func
+        
+    Raises:
+        ClientError: If the call fails with a non-retryable error or
+            retries are exhausted
+    """
+    for attempt in range(1, max_attempts + 1):
+        if limiter is not None:
+            limiter.acquire()
+        try:
+            result = func(*args, **kwargs)
+        except ClientError as e:
+            error_code = e.response.get('Error', {}).get('Code')
+            if error_code in THROTTLING_ERROR_CODES:
+                if limiter is not None:
+                    limiter.on_throttle()
+            elif error_code not in TRANSIENT_ERROR_CODES:
+                raise
+            if attempt == max_attempts:
+                raise
+            reason = error_code
+        except (ConnectionClosedError, EndpointConnectionError) as e:
+            if attempt == max_attempts:
+                raise
+            reason = type(e).__name__
+        else:
+            if limiter is not None:
+                limiter.on_success()
+            return result
+        
+        delay = backoff_delay(attempt, base_delay, max_delay)
+        log_event(logger, logging.DEBUG, "Retrying AWS call", reason=reason,
+                  attempt=attempt, max_attempts=max_attempts, delay=round(delay, 2))
+        time.sleep(delay)
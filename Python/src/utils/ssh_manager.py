@@ -5,36 +5,251 @@ This module provides functionality for managing SSH keys and verifying SSH conne
 """
 
 import os
+import time
+import asyncio
+import base64
+import binascii
+import hashlib
 import logging
+import tempfile
+import threading
 import subprocess
+import weakref
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
 from pathlib import Path
-from typing import Optional, Tuple
-from src.utils.exceptions import SSHManagerError, ResourceNotFoundError
-from src.utils.logging_config import get_logger, LoggingContextManager, log_sensitive_data
+from typing import TYPE_CHECKING, Dict, Iterable, List, Optional, Set, Tuple
+from python.src.utils.exceptions import SSHManagerError, ResourceNotFoundError
+from python.src.utils.known_hosts import KnownHostsFile, known_hosts_entry, parse_known_hosts_line
+from python.src.utils.logging_config import get_logger, log_event, LoggingContextManager, log_sensitive_data
+from python.src.utils.metrics import span, submit_in_context
+
+if TYPE_CHECKING:
+    from python.src.utils.ssh_wait import ReadinessResult
 
 logger = get_logger(__name__)
 
+# Seconds allowed for a single SSH connectivity check
+DEFAULT_CONNECT_TIMEOUT = 10
+# Hosts checked at the same time by verify_connectivity_batch
+DEFAULT_VERIFY_WORKERS = 32
+# Seconds an idle ControlMaster connection is kept open
+DEFAULT_CONTROL_PERSIST = 300
+# OpenSSH expands %C to a hash of local host, remote host, port and user,
+# which keeps socket paths short and unique per destination
+CONTROL_PATH_TOKEN = "%C"
+# Seconds ssh-keyscan waits for each host
+DEFAULT_KEYSCAN_TIMEOUT = 5
+# Hosts passed to a single ssh-keyscan invocation
+KEYSCAN_BATCH_SIZE = 512
+# Directory mtimes this close to a scan may hide changes on filesystems with
+# coarse timestamps, so the key index is rescanned until they are older
+KEY_INDEX_MTIME_WINDOW_NS = 2_000_000_000
+
+DEADLINE_EXCEEDED = "deadline exceeded"
+
+@dataclass
+class KeyInfo:
+    """A managed key pair as seen in the key index."""
+    name: str
+    private_key_path: str
+    public_key_path: str
+    public_key: str
+    fingerprint: Optional[str]
+    mtime_ns: int
+
+def public_key_fingerprint(public_key: str) -> Optional[str]:
+    """Compute the SHA256 fingerprint ssh-keygen -l prints for a public key.
+    
+    Args:
+        public_key: Public key in OpenSSH format
+        
+    Returns:
+        Fingerprint such as SHA256:..., or None if the key can't be parsed
+    """
+    parts = public_key.split()
+    if len(parts) < 2:
+        return None
+    try:
+        blob = base64.b64decode(parts[1], validate=True)
+    except (binascii.Error, ValueError):
+        return None
+    digest = base64.b64encode(hashlib.sha256(blob).digest()).decode().rstrip('=')
+    return f"SHA256:{digest}"
+
+def _control_command(control_path: str, host: str, user: str, port: int,
+                     operation: str) -> List[str]:
+    """Build an ssh -O command for the master connection of a host."""
+    return [
+        "ssh",
+        "-O", operation,
+        "-p", str(port),
+        "-o", f"ControlPath={control_path}",
+        f"{user}@{host}"
+    ]
+
+def _close_master_connections(masters: Set[Tuple[str, str, int]], lock: threading.Lock,
+                              control_path: str) -> None:
+    """Stop the master connections of a manager.
+    
+    Takes the manager's state rather than the manager, so the exit finalizer
+    doesn't keep the manager alive.
+    """
+    with lock:
+        destinations = list(masters)
+        masters.clear()
+    
+    for user, host, port in destinations:
+        try:
+            subprocess.run(
+                _control_command(control_path, host, user, port, "exit"),
+                capture_output=True,
+                text=True,
+                timeout=DEFAULT_CONNECT_TIMEOUT
+            )
+        except (subprocess.SubprocessError, OSError) as e:
+            logger.warning(f"Failed to close SSH master connection to {host}: {str(e)}")
+    if destinations:
+        logger.debug("Closed %d SSH master connections", len(destinations))
+
+@dataclass
+class ConnectivityResult:
+    """Outcome of an SSH connectivity check against one host."""
+    host: str
+    user: str
+    success: bool
+    latency: float
+    error: Optional[str] = None
+
 class SSHManager:
     """Manage SSH keys and verify SSH connectivity."""
 
-    def __init__(self, key_dir: str = "~/.ssh"):
+    def __init__(self, key_dir: str = "~/.ssh", multiplex: bool = False,
+                 control_dir: Optional[str] = None,
+                 control_persist: int = DEFAULT_CONTROL_PERSIST,
+                 key_pool_depth: int = 0):
         """Initialize SSH manager.
         
         Args:
             key_dir: Directory containing SSH keys
+            multiplex: Reuse one ControlMaster connection per host
+            control_dir: Directory for ControlMaster sockets (defaults to <key_dir>/cm)
+            control_persist: Seconds an idle master connection stays open
+            key_pool_depth: Key pairs pre-generated in the background; 0 uses ssh-keygen
             
         Raises:
-            SSHManagerError: If key directory creation fails
+            SSHManagerError: If key directory creation fails, or a key pool is
+                requested without cryptography installed
         """
         try:
             self.key_dir = os.path.expanduser(key_dir)
+            self.multiplex = multiplex
+            self.control_dir = os.path.expanduser(control_dir or os.path.join(self.key_dir, "cm"))
+            self.control_persist = control_persist
+            self.known_hosts = KnownHostsFile(os.path.join(self.key_dir, "known_hosts"))
+            self._async_engine = None
+            self.key_pool = None
+            self._key_lock = threading.Lock()
+            self._keys: Dict[str, KeyInfo] = {}
+            self._key_dir_mtime: Optional[int] = None
+            self._key_scan_started = 0
+            self._masters: Set[Tuple[str, str, int]] = set()
+            self._masters_lock = threading.Lock()
+            # Held while a destination's master connection is checked or opened
+            self._master_locks: Dict[Tuple[str, str, int], threading.Lock] = {}
             os.makedirs(self.key_dir, mode=0o700, exist_ok=True)
+            if multiplex:
+                os.makedirs(self.control_dir, mode=0o700, exist_ok=True)
+                # Closes the masters at exit unless the manager is collected first
+                weakref.finalize(self, _close_master_connections,
+                                 self._masters, self._masters_lock, self.control_path)
+            if key_pool_depth > 0:
+                from python.src.utils.key_pool import KeyPool
+                self.key_pool = KeyPool(key_pool_depth)
             logger.info(f"Initialized SSH manager with key directory: {self.key_dir}")
         except OSError as e:
             raise SSHManagerError(
                 f"Failed to create SSH key directory: {str(e)}"
             ) from e
 
+    def __enter__(self) -> 'SSHManager':
+        """Enter the context; master connections are closed on exit."""
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb) -> None:
+        """Exit the context, close the master connections and stop the key pool."""
+        self.close_masters()
+        if self.key_pool is not None:
+            self.key_pool.close()
+
+    def _refresh_key_index(self) -> None:
+        """Rescan the key directory if it changed; the caller must hold the key lock.
+        
+        Adding, removing or renaming a key changes the directory mtime, so
+        one stat per call is enough to notice it. A change in the same
+        timestamp tick as the last scan leaves the mtime unchanged, so the
+        index is only trusted once the mtime is KEY_INDEX_MTIME_WINDOW_NS
+        older than the scan. Public keys whose own mtime is unchanged keep
+        their parsed entry.
+        """
+        try:
+            mtime = os.stat(self.key_dir).st_mtime_ns
+        except OSError:
+            mtime = None
+        if (mtime is not None and mtime == self._key_dir_mtime
+                and mtime < self._key_scan_started - KEY_INDEX_MTIME_WINDOW_NS):
+            return
+        
+        scan_started = time.time_ns()
+        key_files: Set[str] = set()
+        keys: Dict[str, KeyInfo] = {}
+        try:
+            with os.scandir(self.key_dir) as entries:
+                for entry in entries:
+                    if entry.is_file():
+                        key_files.add(entry.name)
+        except OSError as e:
+            logger.warning(f"Failed to scan SSH key directory: {str(e)}")
+        
+        for file_name in key_files:
+            if not file_name.endswith('.pub'):
+                continue
+            name = file_name[:-len('.pub')]
+            info = self._load_key_info(name, self._keys.get(name))
+            if info is not None:
+                keys[name] = info
+        
+        self._keys, self._key_dir_mtime = keys, mtime
+        self._key_scan_started = scan_started
+        logger.debug("Indexed %d SSH keys in %s", len(keys), self.key_dir)
+
+    def _load_key_info(self, key_name: str, cached: Optional[KeyInfo] = None) -> Optional[KeyInfo]:
+        """Read a public key unless the cached entry has the same mtime."""
+        private_key_path = os.path.join(self.key_dir, key_name)
+        public_key_path = f"{private_key_path}.pub"
+        try:
+            mtime = os.stat(public_key_path).st_mtime_ns
+            if cached is not None and cached.mtime_ns == mtime:
+                return cached
+            with open(public_key_path, 'r') as f:
+                public_key = f.read().strip()
+        except OSError:
+            return None
+        return KeyInfo(
+            key_name, private_key_path, public_key_path, public_key,
+            public_key_fingerprint(public_key), mtime
+        )
+
+    def list_keys(self) -> Dict[str, KeyInfo]:
+        """Get the public key and fingerprint of every key pair in the key directory.
+        
+        Returns:
+            Dictionary of key name to KeyInfo
+        """
+        with self._key_lock:
+            self._refresh_key_index()
+            return dict(self._keys)
+
     def generate_key_pair(self, key_name: str, passphrase: Optional[str] = None) -> Tuple[str, str]:
         """Generate a new SSH key pair.
         
@@ -48,7 +263,8 @@ class SSHManager:
         Raises:
             SSHManagerError: If key generation fails
         """
-        with LoggingContextManager(logger, f"generating SSH key pair: {key_name}"):
+        with LoggingContextManager(logger, f"generating SSH key pair: {key_name}",
+                                   span="ssh.generate_key_pair"):
             private_key_path = os.path.join(self.key_dir, key_name)
             public_key_path = f"{private_key_path}.pub"
             
@@ -56,6 +272,11 @@ class SSHManager:
                 logger.warning(f"SSH key {private_key_path} already exists")
                 return private_key_path, public_key_path
             
+            # Encrypting an OpenSSH private key in-process requires bcrypt, so
+            # passphrase-protected keys are always generated by ssh-keygen
+            if self.key_pool is not None and not passphrase:
+                return self._write_pooled_key_pair(private_key_path, public_key_path)
+            
             try:
                 cmd = ["ssh-keygen", "-t", "ed25519", "-f", private_key_path, "-N", passphrase or ""]
                 result = subprocess.run(
@@ -68,6 +289,8 @@ class SSHManager:
                 # Set correct permissions
                 os.chmod(private_key_path, 0o600)
                 os.chmod(public_key_path, 0o644)
+                with self._key_lock:
+                    self._key_dir_mtime = None
                 
                 logger.info(f"Generated SSH key pair: {private_key_path}")
                 return private_key_path, public_key_path
@@ -83,9 +306,47 @@ class SSHManager:
                     f"Failed to set key permissions: {str(e)}"
                 ) from e
 
+    def _write_pooled_key_pair(self, private_key_path: str, public_key_path: str) -> Tuple[str, str]:
+        """Write an unencrypted key pair taken from the key pool.
+        
+        Raises:
+            SSHManagerError: If the key can't be serialized or the key files can't be written
+        """
+        from python.src.utils.key_pool import serialize_key_pair
+        
+        try:
+            private_bytes, public_key = serialize_key_pair(self.key_pool.acquire())
+            # O_EXCL keeps concurrent callers from overwriting each other's key
+            fd = os.open(private_key_path, os.O_WRONLY | os.O_CREAT | os.O_EXCL, 0o600)
+            with os.fdopen(fd, 'wb') as f:
+                f.write(private_bytes)
+            try:
+                with open(public_key_path, 'w') as f:
+                    f.write(f"{public_key}\n")
+                os.chmod(public_key_path, 0o644)
+            except OSError:
+                # Don't leave a private key without its public key behind
+                os.unlink(private_key_path)
+                raise
+        except SSHManagerError:
+            raise
+        except (OSError, ValueError) as e:
+            logger.error(f"Failed to write SSH key pair: {str(e)}")
+            raise SSHManagerError(
+                f"Failed to write SSH key pair: {str(e)}"
+            ) from e
+        
+        with self._key_lock:
+            self._key_dir_mtime = None
+        logger.info(f"Generated SSH key pair: {private_key_path}")
+        return private_key_path, public_key_path
+
     def get_public_key(self, key_name: str) -> str:
         """Get the public key content.
         
+        Indexed keys are served from memory as long as the .pub file's mtime
+        is unchanged.
+        
         Args:
             key_name: Name of the key pair
             
@@ -96,12 +357,21 @@ class SSHManager:
             ResourceNotFoundError: If public key file doesn't exist
             SSHManagerError: If reading the key fails
         """
+        with self._key_lock:
+            self._refresh_key_index()
+            cached = self._keys.get(key_name)
+            if cached is not None:
+                info = self._load_key_info(key_name, cached)
+                if info is not None:
+                    self._keys[key_name] = info
+                    return info.public_key
+        
         public_key_path = os.path.join(self.key_dir, f"{key_name}.pub")
         
         try:
             with open(public_key_path, 'r') as f:
                 content = f.read().strip()
-            logger.debug(f"Read public key from: {public_key_path}")
+            logger.debug("Read public key from: %s", public_key_path)
             return content
         except FileNotFoundError:
             raise ResourceNotFoundError(
@@ -112,6 +382,149 @@ class SSHManager:
                 f"Failed to read public key: {str(e)}"
             ) from e
 
+    def _private_key_path(self, key_name: str) -> str:
+        """Return the path of an existing private key.
+        
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+        """
+        private_key_path = os.path.join(self.key_dir, key_name)
+        if not os.path.exists(private_key_path):
+            raise ResourceNotFoundError(
+                f"Private key not found: {private_key_path}"
+            )
+        return private_key_path
+
+    @property
+    def control_path(self) -> str:
+        """ControlPath shared by SSHManager and Ansible."""
+        return os.path.join(self.control_dir, CONTROL_PATH_TOKEN)
+
+    def _ssh_command(self, host: str, user: str, private_key_path: str, port: int,
+                     timeout: float, *options: str) -> List[str]:
+        """Build an ssh command line with the options shared by every check."""
+        return [
+            "ssh",
+            "-i", private_key_path,
+            "-p", str(port),
+            "-o", "StrictHostKeyChecking=no",
+            "-o", "BatchMode=yes",
+            "-o", f"ConnectTimeout={max(1, int(timeout))}",
+            *options,
+            f"{user}@{host}"
+        ]
+
+    def _master_alive(self, host: str, user: str, port: int) -> bool:
+        """Check whether the master connection of a host is still running."""
+        try:
+            result = subprocess.run(
+                _control_command(self.control_path, host, user, port, "check"),
+                capture_output=True,
+                text=True,
+                timeout=DEFAULT_CONNECT_TIMEOUT
+            )
+        except (subprocess.SubprocessError, OSError):
+            return False
+        return result.returncode == 0
+
+    def _open_master(self, host: str, user: str, private_key_path: str, port: int,
+                     timeout: float) -> Tuple[bool, Optional[str]]:
+        """Start a background ControlMaster connection to a host unless one is running.
+        
+        Concurrent checks of the same destination wait for each other, so
+        only one of them starts the master connection.
+        
+        Returns:
+            Tuple of (success, error message)
+        """
+        destination = (user, host, port)
+        with self._masters_lock:
+            master_lock = self._master_locks.setdefault(destination, threading.Lock())
+        with master_lock:
+            return self._start_master(destination, private_key_path, timeout)
+    
+    def _start_master(self, destination: Tuple[str, str, int], private_key_path: str,
+                      timeout: float) -> Tuple[bool, Optional[str]]:
+        """Start a master connection; the caller must hold the destination's lock."""
+        user, host, port = destination
+        with self._masters_lock:
+            tracked = destination in self._masters
+        if tracked and self._master_alive(host, user, port):
+            return True, None
+        
+        cmd = self._ssh_command(
+            host, user, private_key_path, port, timeout,
+            "-o", "ControlMaster=yes",
+            "-o", f"ControlPath={self.control_path}",
+            "-o", f"ControlPersist={self.control_persist}",
+            "-f", "-N"
+        )
+        # The backgrounded master inherits stdout and stderr, so a pipe would
+        # never reach EOF; stderr goes to a file that is read after ssh forks
+        with tempfile.TemporaryFile(mode='w+') as stderr:
+            try:
+                result = subprocess.run(
+                    cmd,
+                    stdin=subprocess.DEVNULL,
+                    stdout=subprocess.DEVNULL,
+                    stderr=stderr,
+                    text=True,
+                    timeout=timeout
+                )
+            except subprocess.TimeoutExpired:
+                return False, "timed out"
+            stderr.seek(0)
+            error = stderr.read()
+        
+        if result.returncode != 0:
+            return False, error
+        with self._masters_lock:
+            self._masters.add(destination)
+        log_event(logger, logging.DEBUG, "Opened SSH master connection",
+                  host=host, user=user, port=port)
+        return True, None
+
+    def close_masters(self) -> None:
+        """Stop every master connection opened by this manager."""
+        _close_master_connections(self._masters, self._masters_lock, self.control_path)
+
+    def _check_host(self, host: str, user: str, private_key_path: str, port: int,
+                    timeout: float) -> Tuple[bool, Optional[str]]:
+        """Run a single SSH round trip against a host.
+        
+        With multiplexing enabled, the round trip runs over the host's master
+        connection, which is opened first if needed.
+        
+        Returns:
+            Tuple of (success, error message)
+        """
+        options: List[str] = []
+        if self.multiplex:
+            opened, error = self._open_master(host, user, private_key_path, port, timeout)
+            if not opened:
+                return False, error
+            options = ["-o", "ControlMaster=no", "-o", f"ControlPath={self.control_path}"]
+        
+        cmd = self._ssh_command(host, user, private_key_path, port, timeout, *options)
+        cmd.append("echo 'SSH connection successful'")
+        
+        try:
+            with span("ssh.check"):
+                result = subprocess.run(
+                    cmd,
+                    capture_output=True,
+                    text=True,
+                    timeout=timeout
+                )
+        except subprocess.TimeoutExpired:
+            return False, "timed out"
+        except subprocess.CalledProcessError as e:
+            return False, e.stderr
+        
+        if result.returncode == 0:
+            return True, None
+        return False, result.stderr
+
     def verify_connectivity(self, host: str, user: str, key_name: str, port: int = 22) -> bool:
         """Verify SSH connectivity to a host.
         
@@ -127,54 +540,293 @@ class SSHManager:
         Raises:
             SSHManagerError: If verification fails
         """
-        with LoggingContextManager(logger, f"verifying SSH connectivity to {host}"):
-            private_key_path = os.path.join(self.key_dir, key_name)
-            
-            if not os.path.exists(private_key_path):
-                raise ResourceNotFoundError(
-                    f"Private key not found: {private_key_path}"
-                )
-            
-            cmd = [
-                "ssh",
-                "-i", private_key_path,
-                "-p", str(port),
-                "-o", "StrictHostKeyChecking=no",
-                "-o", "BatchMode=yes",
-                f"{user}@{host}",
-                "echo 'SSH connection successful'"
-            ]
+        with LoggingContextManager(logger, f"verifying SSH connectivity to {host}",
+                                   span="ssh.verify_connectivity"):
+            private_key_path = self._private_key_path(key_name)
             
             try:
-                result = subprocess.run(
-                    cmd,
-                    capture_output=True,
-                    text=True,
-                    timeout=10
+                success, error = self._check_host(
+                    host, user, private_key_path, port, DEFAULT_CONNECT_TIMEOUT
                 )
-                
-                if result.returncode == 0:
-                    logger.info(f"Successfully connected to {host}")
-                    return True
-                else:
-                    logger.error(f"Failed to connect to {host}: {result.stderr}")
-                    return False
-                    
-            except subprocess.TimeoutExpired:
-                logger.error(f"Connection to {host} timed out")
-                return False
-            except subprocess.CalledProcessError as e:
-                logger.error(f"SSH command failed: {e.stderr}")
-                return False
             except Exception as e:
                 logger.error(f"Unexpected error connecting to {host}", exc_info=True)
                 raise SSHManagerError(
                     f"Unexpected error connecting to {host}: {str(e)}"
                 ) from e
+            
+            if success:
+                logger.info(f"Successfully connected to {host}")
+            else:
+                logger.error(f"Failed to connect to {host}: {error}")
+            return success
+
+    def verify_connectivity_batch(
+        self,
+        hosts: Iterable[Tuple[str, str]],
+        key_name: str,
+        port: int = 22,
+        max_workers: int = DEFAULT_VERIFY_WORKERS,
+        deadline: Optional[float] = None,
+        timeout: float = DEFAULT_CONNECT_TIMEOUT
+    ) -> Dict[str, ConnectivityResult]:
+        """Verify SSH connectivity to many hosts concurrently.
+        
+        Checks run on a bounded thread pool. Once the deadline has passed,
+        checks that have not started yet are not attempted and running checks
+        are cut short, so the batch returns shortly after the deadline.
+        
+        Args:
+            hosts: (host, user) pairs to check
+            key_name: Name of the private key
+            port: SSH port
+            max_workers: Maximum number of hosts checked at the same time
+            deadline: Seconds allowed for the whole batch, or None for no limit
+            timeout: Seconds allowed for each host
+            
+        Returns:
+            Dictionary of host to ConnectivityResult
+            
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+        """
+        targets: List[Tuple[str, str]] = list(hosts)
+        private_key_path = self._private_key_path(key_name)
+        if not targets:
+            return {}
+        
+        started = time.monotonic()
+        deadline_at = started + deadline if deadline is not None else None
+        
+        def check(host: str, user: str) -> ConnectivityResult:
+            host_timeout = timeout
+            if deadline_at is not None:
+                host_timeout = min(timeout, deadline_at - time.monotonic())
+                if host_timeout <= 0:
+                    return ConnectivityResult(host, user, False, 0.0, DEADLINE_EXCEEDED)
+            
+            check_started = time.monotonic()
+            try:
+                success, error = self._check_host(
+                    host, user, private_key_path, port, host_timeout
+                )
+            except Exception as e:
+                success, error = False, str(e)
+            return ConnectivityResult(
+                host, user, success, time.monotonic() - check_started, error
+            )
+        
+        with ThreadPoolExecutor(max_workers=max(1, min(max_workers, len(targets)))) as executor:
+            futures = [submit_in_context(executor, check, host, user) for host, user in targets]
+            results = {result.host: result for result in (f.result() for f in futures)}
+        
+        reachable = sum(1 for result in results.values() if result.success)
+        logger.info(
+            f"Verified SSH connectivity to {reachable}/{len(results)} hosts "
+            f"in {time.monotonic() - started:.2f} seconds"
+        )
+        for result in results.values():
+            if not result.success:
+                log_event(logger, logging.DEBUG, "Failed to connect",
+                          host=result.host, error=result.error, latency=round(result.latency, 3))
+        return results
+
+    @property
+    def async_engine(self):
+        """Get the asyncssh engine used by the coroutine methods.
+        
+        Raises:
+            SSHManagerError: If asyncssh is not installed
+        """
+        if self._async_engine is None:
+            from python.src.utils.async_ssh import AsyncSSHEngine
+            self._async_engine = AsyncSSHEngine()
+        return self._async_engine
+
+    async def verify_connectivity_async(self, host: str, user: str, key_name: str,
+                                        port: int = 22) -> bool:
+        """Verify SSH connectivity to a host without spawning ssh.
+        
+        Args:
+            host: Target host
+            user: SSH user
+            key_name: Name of the private key
+            port: SSH port
+            
+        Returns:
+            True if connection is successful, False otherwise
+            
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+            SSHManagerError: If asyncssh is not installed
+        """
+        private_key_path = self._private_key_path(key_name)
+        result = await self.async_engine.check(host, user, private_key_path, port)
+        if result.success:
+            logger.info(f"Successfully connected to {host}")
+        else:
+            logger.error(f"Failed to connect to {host}: {result.error}")
+        return result.success
+
+    async def verify_connectivity_batch_async(
+        self,
+        hosts: Iterable[Tuple[str, str]],
+        key_name: str,
+        port: int = 22,
+        concurrency: Optional[int] = None,
+        deadline: Optional[float] = None
+    ) -> Dict[str, ConnectivityResult]:
+        """Verify SSH connectivity to many hosts on one event loop.
+        
+        Args:
+            hosts: (host, user) pairs to check
+            key_name: Name of the private key
+            port: SSH port
+            concurrency: Maximum number of handshakes in flight
+            deadline: Seconds allowed for the whole batch, or None for no limit
+            
+        Returns:
+            Dictionary of host to ConnectivityResult
+            
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+            SSHManagerError: If asyncssh is not installed
+        """
+        private_key_path = self._private_key_path(key_name)
+        started = time.monotonic()
+        results = await self.async_engine.check_many(
+            hosts, private_key_path, port, deadline, concurrency
+        )
+        reachable = sum(1 for result in results.values() if result.success)
+        logger.info(
+            f"Verified SSH connectivity to {reachable}/{len(results)} hosts "
+            f"in {time.monotonic() - started:.2f} seconds"
+        )
+        return results
+
+    async def add_to_known_hosts_async(self, host: str, port: int = 22) -> None:
+        """Add a host to known_hosts without spawning ssh-keyscan.
+        
+        Args:
+            host: Target host
+            port: SSH port
+            
+        Raises:
+            SSHManagerError: If the host key can't be fetched or written
+        """
+        line = await self.async_engine.scan_host_key(host, port)
+        if line is None:
+            raise SSHManagerError(f"Failed to get host key: {host}")
+        
+        self.known_hosts.merge([line])
+        logger.info(f"Added {host} to known_hosts")
+
+    async def add_many_to_known_hosts_async(self, hosts: Iterable[str],
+                                            port: int = 22) -> Dict[str, bool]:
+        """Add many hosts to known_hosts, fetching their keys concurrently.
+        
+        Args:
+            hosts: Target hosts
+            port: SSH port
+            
+        Returns:
+            Dictionary of host to whether its key was fetched
+            
+        Raises:
+            SSHManagerError: If known_hosts can't be updated
+        """
+        lines = await self.async_engine.scan_host_keys(hosts, port)
+        added, replaced = self.known_hosts.merge(line for line in lines.values() if line)
+        logger.info(
+            f"Scanned {sum(1 for line in lines.values() if line)}/{len(lines)} hosts: "
+            f"{added} keys added, {replaced} replaced in known_hosts"
+        )
+        return {host: line is not None for host, line in lines.items()}
+
+    async def wait_for_ssh_async(
+        self,
+        hosts: Iterable[Tuple[str, str]],
+        key_name: str,
+        port: int = 22,
+        timeout: Optional[float] = None,
+        concurrency: Optional[int] = None
+    ) -> Dict[str, 'ReadinessResult']:
+        """Wait for newly launched hosts to accept SSH connections.
+        
+        Each host is probed over TCP with exponential backoff; a full SSH
+        handshake is only attempted once the host sends an SSH banner.
+        
+        Args:
+            hosts: (host, user) pairs to wait for
+            key_name: Name of the private key
+            port: SSH port
+            timeout: Seconds to wait for each host
+            concurrency: Maximum number of hosts polled at the same time
+            
+        Returns:
+            Dictionary of host to ReadinessResult with the time to ready
+            
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+        """
+        from python.src.utils import ssh_wait
+        private_key_path = self._private_key_path(key_name)
+        
+        def check(host: str, user: str, check_timeout: float) -> Tuple[bool, Optional[str]]:
+            try:
+                return self._check_host(host, user, private_key_path, port, check_timeout)
+            except Exception as e:
+                return False, str(e)
+        
+        results = await ssh_wait.wait_until_ready(
+            hosts,
+            check,
+            port,
+            ssh_wait.DEFAULT_WAIT_TIMEOUT if timeout is None else timeout,
+            concurrency or ssh_wait.DEFAULT_WAIT_CONCURRENCY
+        )
+        ready = [result for result in results.values() if result.ready]
+        if ready:
+            logger.info(
+                f"SSH ready on {len(ready)}/{len(results)} hosts, slowest after "
+                f"{max(result.elapsed for result in ready):.1f} seconds"
+            )
+        for result in results.values():
+            if not result.ready:
+                logger.error(f"SSH not available on {result.host}: {result.error}")
+        return results
+
+    def wait_for_ssh(
+        self,
+        hosts: Iterable[Tuple[str, str]],
+        key_name: str,
+        port: int = 22,
+        timeout: Optional[float] = None,
+        concurrency: Optional[int] = None
+    ) -> Dict[str, 'ReadinessResult']:
+        """Blocking wrapper around wait_for_ssh_async for callers without an event loop.
+        
+        Args:
+            hosts: (host, user) pairs to wait for
+            key_name: Name of the private key
+            port: SSH port
+            timeout: Seconds to wait for each host
+            concurrency: Maximum number of hosts polled at the same time
+            
+        Returns:
+            Dictionary of host to ReadinessResult with the time to ready
+            
+        Raises:
+            ResourceNotFoundError: If the private key doesn't exist
+        """
+        return asyncio.run(
+            self.wait_for_ssh_async(hosts, key_name, port, timeout, concurrency)
+        )
 
     def add_to_known_hosts(self, host: str, port: int = 22) -> None:
         """Add a host to known_hosts file.
         
+        Existing keys of the host are replaced rather than duplicated.
+        
         Args:
             host: Target host
             port: SSH port
@@ -182,33 +834,94 @@ class SSHManager:
         Raises:
             SSHManagerError: If adding to known_hosts fails
         """
-        with LoggingContextManager(logger, f"adding {host} to known_hosts"):
-            known_hosts_path = os.path.join(self.key_dir, "known_hosts")
+        with LoggingContextManager(logger, f"adding {host} to known_hosts",
+                                   span="ssh.add_to_known_hosts"):
+            scanned = self.add_many_to_known_hosts([host], port)
+            if not scanned.get(host):
+                raise SSHManagerError(f"Failed to get host key: {host}")
             
+            logger.info(f"Added {host} to known_hosts")
+
+    def add_many_to_known_hosts(
+        self,
+        hosts: Iterable[str],
+        port: int = 22,
+        timeout: int = DEFAULT_KEYSCAN_TIMEOUT,
+        batch_size: int = KEYSCAN_BATCH_SIZE
+    ) -> Dict[str, bool]:
+        """Add many hosts to known_hosts with batched ssh-keyscan calls.
+        
+        ssh-keyscan scans all hosts of a batch concurrently. The scanned keys
+        are merged into known_hosts in one atomic rewrite, replacing existing
+        keys of the same host and key type.
+        
+        Args:
+            hosts: Target hosts
+            port: SSH port
+            timeout: Seconds ssh-keyscan waits for each host
+            batch_size: Hosts passed to one ssh-keyscan invocation
+            
+        Returns:
+            Dictionary of host to whether its key was fetched
+            
+        Raises:
+            SSHManagerError: If ssh-keyscan can't be run or the known_hosts update fails
+        """
+        targets = list(dict.fromkeys(hosts))
+        lines: List[str] = []
+        
+        for start in range(0, len(targets), max(1, batch_size)):
+            cmd = ["ssh-keyscan", "-p", str(port), "-T", str(timeout)]
+            cmd.extend(targets[start:start + batch_size])
             try:
-                os.makedirs(os.path.dirname(known_hosts_path), mode=0o700, exist_ok=True)
-                
-                cmd = ["ssh-keyscan", "-p", str(port), host]
-                result = subprocess.run(
-                    cmd,
-                    capture_output=True,
-                    text=True,
-                    check=True
-                )
-                
-                with open(known_hosts_path, 'a') as f:
-                    f.write(result.stdout)
-                
-                logger.info(f"Added {host} to known_hosts")
-                
-            except subprocess.CalledProcessError as e:
-                raise SSHManagerError(
-                    f"Failed to get host key: {e.stderr}"
-                ) from e
+                with span("ssh.keyscan"):
+                    result = subprocess.run(
+                        cmd,
+                        capture_output=True,
+                        text=True
+                    )
             except OSError as e:
                 raise SSHManagerError(
-                    f"Failed to write to known_hosts: {str(e)}"
+                    f"Failed to run ssh-keyscan: {str(e)}"
                 ) from e
+            # The hosts ssh-keyscan couldn't reach are reported as not scanned
+            if result.returncode != 0:
+                logger.warning(
+                    f"ssh-keyscan exited with status {result.returncode}: "
+                    f"{result.stderr.strip()}"
+                )
+            lines.extend(result.stdout.splitlines())
+        
+        scanned = set()
+        for line in lines:
+            parsed = parse_known_hosts_line(line)
+            if parsed is not None:
+                scanned.update(parsed[0])
+        
+        added, replaced = self.known_hosts.merge(lines)
+        results = {host: known_hosts_entry(host, port) in scanned for host in targets}
+        logger.info(
+            f"Scanned {sum(results.values())}/{len(targets)} hosts: "
+            f"{added} keys added, {replaced} replaced in known_hosts"
+        )
+        return results
+
+    def remove_from_known_hosts(self, hosts: Iterable[str], port: int = 22) -> int:
+        """Remove the keys of hosts that no longer exist from known_hosts.
+        
+        Args:
+            hosts: Hosts to forget
+            port: SSH port
+            
+        Returns:
+            Number of keys removed
+            
+        Raises:
+            SSHManagerError: If known_hosts can't be updated
+        """
+        removed = self.known_hosts.remove(hosts, port)
+        logger.info(f"Removed {removed} keys from known_hosts")
+        return removed
 
 def setup_ssh_key(key_name: str, passphrase: Optional[str] = None) -> Tuple[str, str]:
     """Set up SSH key pair.
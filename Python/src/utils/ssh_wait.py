@@ -0,0 +1,127 @@
+"""
+SSH Readiness Polling
+
+This module waits for newly launched hosts to accept SSH connections. Each
+host is polled with a cheap asynchronous TCP probe that also reads the SSH
+banner, so an open port on a booting host isn't mistaken for a running sshd.
+Only once the banner arrives is a full SSH handshake attempted. Polls back
+off exponentially with jitter, and all hosts are polled on one event loop.
+"""
+
+import asyncio
+import logging
+import time
+import contextvars
+from dataclasses import dataclass
+from typing import Callable, Dict, Iterable, Optional, Tuple
+from python.src.utils.logging_config import get_logger, log_event
+from python.src.utils.retry import backoff_delay
+
+logger = get_logger(__name__)
+
+# Seconds to wait for a host to become reachable over SSH
+DEFAULT_WAIT_TIMEOUT = 600
+# Seconds allowed for one TCP probe, including the banner read
+PROBE_TIMEOUT = 3.0
+# Seconds allowed for one SSH handshake once the banner was seen
+HANDSHAKE_TIMEOUT = 10.0
+# Bounds of the delay between polls of the same host
+MIN_POLL_INTERVAL = 0.5
+MAX_POLL_INTERVAL = 15.0
+# Hosts polled at the same time
+DEFAULT_WAIT_CONCURRENCY = 256
+
+@dataclass
+class ReadinessResult:
+    """Outcome of waiting for SSH on one host."""
+    host: str
+    user: str
+    ready: bool
+    elapsed: float
+    probes: int
+    error: Optional[str] = None
+
+async def probe_ssh_port(host: str, port: int = 22, timeout: float = PROBE_TIMEOUT) -> bool:
+    """Check that a host accepts TCP connections and sends an SSH banner.
+    
+    Args:
+        host: Target host
+        port: SSH port
+        timeout: Seconds allowed for the connection and banner
+    
+    Returns:
+        True if an SSH server answered
+    """
+    writer = None
+    try:
+        reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), timeout)
+        banner = await asyncio.wait_for(reader.readline(), timeout)
+        return banner.startswith(b"SSH-")
+    except (OSError, asyncio.TimeoutError):
+        return False
+    finally:
+        if writer is not None:
+            writer.close()
+            # Wait for the transport to close so it isn't left for the GC
+            try:
+                await asyncio.wait_for(writer.wait_closed(), timeout)
+            except (OSError, asyncio.TimeoutError):
+                pass
+
+async def wait_until_ready(
+    hosts: Iterable[Tuple[str, str]],
+    check: Callable[[str, str, float], Tuple[bool, Optional[str]]],
+    port: int = 22,
+    timeout: float = DEFAULT_WAIT_TIMEOUT,
+    concurrency: int = DEFAULT_WAIT_CONCURRENCY
+) -> Dict[str, ReadinessResult]:
+    """Poll hosts until each completes an SSH handshake or the timeout passes.
+    
+    Args:
+        hosts: (host, user) pairs to wait for
+        check: Blocking handshake check called as check(host, user, timeout)
+        port: SSH port
+        timeout: Seconds to wait for each host
+        concurrency: Maximum number of hosts polled at the same time
+    
+    Returns:
+        Dictionary of host to ReadinessResult
+    """
+    loop = asyncio.get_running_loop()
+    semaphore = asyncio.Semaphore(max(1, concurrency))
+
+    async def wait_for_host(host: str, user: str) -> ReadinessResult:
+        started = time.monotonic()
+        deadline = started + timeout
+        probes = 0
+        error = "timed out"
+        
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return ReadinessResult(host, user, False, time.monotonic() - started, probes, error)
+            
+            probes += 1
+            async with semaphore:
+                if await probe_ssh_port(host, port, min(PROBE_TIMEOUT, remaining)):
+                    handshake_timeout = min(
+                        HANDSHAKE_TIMEOUT, max(1.0, deadline - time.monotonic())
+                    )
+                    # run_in_executor doesn't carry the task's context to the thread
+                    ready, error = await loop.run_in_executor(
+                        None, contextvars.copy_context().run, check, host, user,
+                        handshake_timeout
+                    )
+                    if ready:
+                        elapsed = time.monotonic() - started
+                        log_event(logger, logging.INFO, "SSH ready", host=host,
+                                  elapsed=round(elapsed, 3), probes=probes)
+                        return ReadinessResult(host, user, True, elapsed, probes)
+                else:
+                    error = "SSH port not open"
+            
+            delay = max(MIN_POLL_INTERVAL, backoff_delay(probes, MIN_POLL_INTERVAL, MAX_POLL_INTERVAL))
+            await asyncio.sleep(min(delay, max(0.0, deadline - time.monotonic())))
+    
+    results = await asyncio.gather(*(wait_for_host(host, user) for host, user in hosts))
+    return {result.host: result for result in results}
@@ -0,0 +1,70 @@
+"""
+Unit tests for the tuned Ansible settings.
+"""
+
+import os
+import pytest
+from python.src.utils.ansible_config import AnsibleConfig, clear_cached_facts
+
+@pytest.fixture
+def control_dir(tmp_path):
+    """Short control socket directory."""
+    return os.path.join(tmp_path, 'cm')
+
+def test_envvars(control_dir):
+    """Test pipelining, ControlPersist and the hashed control path."""
+    envvars = AnsibleConfig(control_persist=600, control_dir=control_dir).envvars()
+    
+    assert envvars['ANSIBLE_PIPELINING'] == 'True'
+    assert '-o ControlMaster=auto' in envvars['ANSIBLE_SSH_ARGS']
+    assert '-o ControlPersist=600s' in envvars['ANSIBLE_SSH_ARGS']
+    assert envvars['ANSIBLE_SSH_CONTROL_PATH_DIR'] == control_dir
+    assert envvars['ANSIBLE_SSH_CONTROL_PATH'] == f"{control_dir}/%%C"
+    # Settings that aren't tuned are left to the user's ansible.cfg
+    assert 'ANSIBLE_CONFIG' not in envvars
+    assert 'ANSIBLE_GATHERING' not in envvars
+
+def test_envvars_without_pipelining(control_dir):
+    """Test disabling pipelining for hosts that require a tty for sudo."""
+    envvars = AnsibleConfig(pipelining=False, control_dir=control_dir).envvars()
+    
+    assert envvars['ANSIBLE_PIPELINING'] == 'False'
+
+def test_envvars_fact_cache(tmp_path, control_dir):
+    """Test the jsonfile fact cache and smart gathering settings."""
+    cache_dir = os.path.join(tmp_path, 'facts')
+    envvars = AnsibleConfig(control_dir=control_dir, fact_cache_dir=cache_dir,
+                            fact_cache_timeout=600).envvars()
+    
+    assert envvars['ANSIBLE_GATHERING'] == 'smart'
+    assert envvars['ANSIBLE_CACHE_PLUGIN'] == 'jsonfile'
+    assert envvars['ANSIBLE_CACHE_PLUGIN_CONNECTION'] == cache_dir
+    assert envvars['ANSIBLE_CACHE_PLUGIN_TIMEOUT'] == '600'
+
+def test_prepare_creates_directories(tmp_path, control_dir):
+    """Test that the control and fact cache directories exist after preparing."""
+    cache_dir = os.path.join(tmp_path, 'facts')
+    config = AnsibleConfig(control_dir=control_dir, fact_cache_dir=cache_dir)
+    
+    assert config.prepare() == config.envvars()
+    assert os.stat(control_dir).st_mode & 0o777 == 0o700
+    assert os.stat(cache_dir).st_mode & 0o777 == 0o700
+
+def test_control_dir_too_long(tmp_path):
+    """Test that control sockets must fit the Unix socket path limit."""
+    control_dir = os.path.join(tmp_path, 'd' * 60)
+    
+    with pytest.raises(Exception) as exc_info:
+        AnsibleConfig(control_dir=control_dir).prepare()
+    
+    assert type(exc_info.value).__name__ == 'ConfigurationError'
+    assert not os.path.exists(control_dir)
+
+def test_clear_cached_facts(tmp_path):
+    """Test removing the cached facts of some hosts."""
+    for host in ('web-1', 'web-2'):
+        with open(os.path.join(tmp_path, host), 'w') as f:
+            f.write('{}')
+    
+    assert clear_cached_facts(tmp_path, ['web-1', 'web-3']) == 1
+    assert os.listdir(tmp_path) == ['web-2']
@@ -0,0 +1,114 @@
+"""
+Unit tests for the asyncssh-based SSH engine.
+"""
+
+import os
+import sys
+import asyncio
+import pytest
+from unittest.mock import Mock, patch
+from python.src.utils.async_ssh import AsyncSSHEngine
+from python.src.utils.ssh_manager import SSHManager
+
+class FakeConnection:
+    """Connection returned by the fake asyncssh.connect."""
+
+    def __init__(self, exit_status):
+        self.exit_status = exit_status
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, *exc_info):
+        return False
+
+    async def run(self, command, check=False):
+        return Mock(exit_status=self.exit_status)
+
+@pytest.fixture
+def fake_asyncssh():
+    """Install a fake asyncssh module."""
+    module = Mock()
+    module.read_private_key.return_value = 'client-key'
+
+    def connect(host, **kwargs):
+        if host == 'down-host':
+            raise OSError("Connection refused")
+        return FakeConnection(0 if host != 'denied-host' else 1)
+    module.connect.side_effect = connect
+
+    async def get_server_host_key(host, port):
+        key = Mock()
+        key.export_public_key.return_value = b'ssh-ed25519 AAAAC3NzaC1lZDI1NTE5 comment\n'
+        return key
+    module.get_server_host_key.side_effect = get_server_host_key
+
+    with patch.dict(sys.modules, {'asyncssh': module}):
+        yield module
+
+@pytest.fixture
+def ssh_manager(tmp_path):
+    """Create SSHManager with a private key in a temporary directory."""
+    with open(os.path.join(tmp_path, 'test-key'), 'w') as f:
+        f.write('private key')
+    return SSHManager(str(tmp_path))
+
+def test_verify_connectivity_async(ssh_manager, fake_asyncssh):
+    """Test verifying one host over asyncssh."""
+    assert asyncio.run(
+        ssh_manager.verify_connectivity_async('test-host', 'user', 'test-key')
+    ) is True
+
+    _, kwargs = fake_asyncssh.connect.call_args
+    assert kwargs['username'] == 'user'
+    assert kwargs['client_keys'] == ['client-key']
+
+def test_verify_connectivity_batch_async(ssh_manager, fake_asyncssh):
+    """Test verifying many hosts on one event loop."""
+    results = asyncio.run(ssh_manager.verify_connectivity_batch_async(
+        [('test-host', 'user'), ('down-host', 'user'), ('denied-host', 'user')],
+        'test-key',
+        concurrency=2
+    ))
+
+    assert results['test-host'].success is True
+    assert results['down-host'].success is False
+    assert results['down-host'].error == "Connection refused"
+    assert results['denied-host'].error == "exit status 1"
+    # The private key is parsed once for the whole batch
+    fake_asyncssh.read_private_key.assert_called_once()
+
+def test_check_many_unreadable_key(fake_asyncssh):
+    """Test that a key that can't be loaded fails each host instead of the batch."""
+    fake_asyncssh.read_private_key.side_effect = OSError("Permission denied")
+
+    results = asyncio.run(AsyncSSHEngine().check_many(
+        [('test-host', 'user'), ('other-host', 'user')], '/missing/key'
+    ))
+
+    assert [result.success for result in results.values()] == [False, False]
+    assert "Permission denied" in results['test-host'].error
+
+def test_verify_connectivity_batch_async_deadline(ssh_manager, fake_asyncssh):
+    """Test that no handshakes start after the deadline."""
+    results = asyncio.run(ssh_manager.verify_connectivity_batch_async(
+        [('test-host', 'user')], 'test-key', deadline=0
+    ))
+
+    assert results['test-host'].error == "deadline exceeded"
+    fake_asyncssh.connect.assert_not_called()
+
+def test_add_to_known_hosts_async(ssh_manager, fake_asyncssh):
+    """Test adding a host key fetched over asyncssh."""
+    asyncio.run(ssh_manager.add_to_known_hosts_async('test-host', port=2222))
+
+    with open(os.path.join(ssh_manager.key_dir, 'known_hosts')) as f:
+        assert f.read() == "[test-host]:2222 ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n"
+
+def test_async_engine_requires_asyncssh(ssh_manager):
+    """Test the error raised when asyncssh is not installed."""
+    with patch.dict(sys.modules, {'asyncssh': None}):
+        with pytest.raises(Exception) as exc_info:
+            ssh_manager.async_engine
+
+    assert type(exc_info.value).__name__ == 'SSHManagerError'
@@ -0,0 +1,69 @@
+"""
+Unit tests for the AWS client registry.
+"""
+
+import threading
+import pytest
+from unittest.mock import patch
+from python.src.utils.aws_clients import AWSClientRegistry
+
+@pytest.fixture
+def mock_session():
+    """Mock boto3 session class."""
+    with patch('boto3.session.Session') as mock_session_class:
+        yield mock_session_class
+
+def test_client_created_once(mock_session):
+    """Test that a client is created once per service and region."""
+    registry = AWSClientRegistry()
+    
+    first = registry.client('ec2', 'us-west-2')
+    second = registry.client('ec2', 'us-west-2')
+    registry.client('ec2', 'eu-west-1')
+    
+    assert first is second
+    assert mock_session.call_count == 1
+    assert mock_session.return_value.client.call_count == 2
+
+def test_session_per_profile(mock_session):
+    """Test that every profile gets its own session."""
+    registry = AWSClientRegistry()
+    
+    registry.client('ec2', 'us-west-2', profile='prod')
+    registry.client('ec2', 'us-west-2', profile='staging')
+    
+    assert [call.kwargs['profile_name'] for call in mock_session.call_args_list] == ['prod', 'staging']
+
+def test_client_concurrent_creation(mock_session):
+    """Test that concurrent callers share a single client."""
+    registry = AWSClientRegistry()
+    clients = []
+    threads = [
+        threading.Thread(target=lambda: clients.append(registry.client('ec2', 'us-west-2')))
+        for _ in range(8)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    
+    assert mock_session.return_value.client.call_count == 1
+    assert all(client is clients[0] for client in clients)
+
+def test_credentials_identity(mock_session):
+    """Test identifying credentials without an API call."""
+    registry = AWSClientRegistry()
+    mock_session.return_value.get_credentials.return_value.access_key = 'AKIATEST'
+    assert registry.credentials_identity() == 'AKIATEST'
+    
+    mock_session.return_value.get_credentials.return_value = None
+    assert registry.credentials_identity('prod') == 'profile:prod'
+
+def test_clear(mock_session):
+    """Test dropping cached clients."""
+    registry = AWSClientRegistry()
+    registry.client('ec2', 'us-west-2')
+    registry.clear()
+    registry.client('ec2', 'us-west-2')
+    
+    assert mock_session.return_value.client.call_count == 2
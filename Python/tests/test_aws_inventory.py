@@ -2,24 +2,35 @@
 Unit tests for AWS inventory generation.
 """
 
+import io
 import json
 import pytest
 import boto3
+from botocore.exceptions import ClientError
 from unittest.mock import Mock, patch
-from python.src.inventory.aws_inventory import AWSInventoryGenerator
+from python.src.inventory.aws_inventory import (
+    AWSInventoryGenerator,
+    build_filters,
+    client_registry,
+    find_host_vars,
+    generate_aws_inventory,
+    generate_multi_region_inventory,
+    main as dynamic_inventory_main,
+    parse_tag_filters,
+    resolve_regions,
+    write_dynamic_inventory
+)
+from python.src.inventory.cache import InventoryCache
 from python.src.utils.exceptions import CloudProviderError, ResourceNotFoundError
 
 @pytest.fixture
 def mock_ec2_client():
-    """Mock EC2 client fixture."""
-    with patch('boto3.client') as mock_client:
-        yield mock_client
-
-@pytest.fixture
-def mock_ec2_resource():
-    """Mock EC2 resource fixture."""
-    with patch('boto3.resource') as mock_resource:
-        yield mock_resource
+    """Mock EC2 client fixture, called as session.client('ec2', region_name=...)."""
+    client_registry.clear()
+    with patch('boto3.session.Session') as mock_session:
+        mock_session.return_value.get_credentials.return_value.access_key = 'AKIATEST'
+        yield mock_session.return_value.client
+    client_registry.clear()
 
 @pytest.fixture
 def sample_instances():
@@ -32,6 +43,8 @@ def sample_instances():
                         'InstanceId': 'i-1234567890abcdef0',
                         'InstanceType': 't2.micro',
                         'State': {'Name': 'running'},
+                        'Placement': {'AvailabilityZone': 'us-west-2a'},
+                        'VpcId': 'vpc-0abc',
                         'PrivateIpAddress': '10.0.0.1',
                         'PublicIpAddress': '54.0.0.1',
                         'Tags': [
@@ -72,6 +85,98 @@ def test_get_instances(mock_ec2_client, sample_instances):
     assert instances[0]['public_ip'] == '54.0.0.1'
     assert instances[0]['tags']['Role'] == 'webserver'
 
+def test_get_instances_server_side_filters(mock_ec2_client, sample_instances):
+    """Test that state and tag filters are sent to the EC2 API."""
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.return_value = sample_instances
+    
+    generator = AWSInventoryGenerator('us-west-2', tags={'Role': ['webserver']})
+    generator.get_instances()
+    
+    _, kwargs = describe_instances.call_args
+    assert kwargs['Filters'] == [
+        {'Name': 'instance-state-name', 'Values': ['running']},
+        {'Name': 'tag:Role', 'Values': ['webserver']}
+    ]
+
+def test_build_filters_states():
+    """Test building filters for several instance states."""
+    assert build_filters(['running', 'stopped']) == [
+        {'Name': 'instance-state-name', 'Values': ['running', 'stopped']}
+    ]
+
+def test_build_filters_invalid_state():
+    """Test that unknown instance states are rejected."""
+    with pytest.raises(Exception) as exc_info:
+        build_filters(['sleeping'])
+    
+    assert 'sleeping' in str(exc_info.value)
+
+def test_parse_tag_filters():
+    """Test parsing command-line tag filters."""
+    assert parse_tag_filters(['Role=webserver,proxy', 'Env=prod', 'Role=cache']) == {
+        'Role': ['webserver', 'proxy', 'cache'],
+        'Env': ['prod']
+    }
+
+def test_parse_tag_filters_invalid():
+    """Test that malformed tag filters are rejected."""
+    with pytest.raises(Exception) as exc_info:
+        parse_tag_filters(['Role'])
+    
+    assert 'KEY=VALUE' in str(exc_info.value)
+
+def test_clients_shared_between_generators(mock_ec2_client):
+    """Test that generators of one region share a lazily created client."""
+    first = AWSInventoryGenerator('us-west-2')
+    second = AWSInventoryGenerator('us-west-2')
+    
+    assert mock_ec2_client.call_count == 0
+    assert first.ec2_client is second.ec2_client
+    mock_ec2_client.assert_called_once()
+    assert mock_ec2_client.call_args.kwargs['region_name'] == 'us-west-2'
+
+def test_get_instances_multiple_pages(mock_ec2_client, sample_instances):
+    """Test that NextToken is followed and instances from every page are returned."""
+    first_page = {'Reservations': sample_instances['Reservations'][:1], 'NextToken': 'token'}
+    second_page = {
+        'Reservations': [{
+            'Instances': [{
+                'InstanceId': 'i-0aaaaaaaaaaaaaaa0',
+                'InstanceType': 't3.large',
+                'State': {'Name': 'running'},
+                'PrivateIpAddress': '10.0.0.3'
+            }]
+        }]
+    }
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.side_effect = [first_page, second_page]
+    
+    generator = AWSInventoryGenerator('us-west-2')
+    instances = generator.get_instances()
+    
+    assert [i['id'] for i in instances] == [
+        'i-1234567890abcdef0', 'i-0987654321fedcba0', 'i-0aaaaaaaaaaaaaaa0'
+    ]
+    assert describe_instances.call_count == 2
+    assert describe_instances.call_args_list[1].kwargs['NextToken'] == 'token'
+
+def test_iter_instances_is_lazy(mock_ec2_client, sample_instances):
+    """Test that iter_instances yields before later pages are fetched."""
+    fetched = []
+    
+    def describe_instances(**request):
+        fetched.append(request)
+        return dict(sample_instances, NextToken='token')
+    
+    mock_ec2_client.return_value.describe_instances.side_effect = describe_instances
+    
+    generator = AWSInventoryGenerator('us-west-2')
+    first = next(generator.iter_instances())
+    
+    assert first['id'] == 'i-1234567890abcdef0'
+    assert len(fetched) == 1
+
 def test_generate_inventory(mock_ec2_client, sample_instances, tmp_path):
     """Test inventory generation."""
     mock_ec2_client.return_value.describe_instances.return_value = sample_instances
@@ -89,7 +194,9 @@ def test_generate_inventory(mock_ec2_client, sample_instances, tmp_path):
     assert 'webservers' in inventory['all']['children']
     
     # Check webserver instance
-    webserver = inventory['all']['children']['webservers']['hosts']['i-1234567890abcdef0']
+    assert 'i-1234567890abcdef0' in inventory['all']['children']['webservers']['hosts']
+    assert 'i-0987654321fedcba0' not in inventory['all']['children']['webservers']['hosts']
+    webserver = inventory['all']['hosts']['i-1234567890abcdef0']
     assert webserver['ansible_host'] == '54.0.0.1'
     assert webserver['instance_type'] == 't2.micro'
     
@@ -118,4 +225,202 @@ def test_generate_inventory_error(mock_ec2_client, tmp_path):
     with pytest.raises(Exception) as exc_info:
         generator.generate_inventory(str(output_file))
     
-    assert str(exc_info.value) == "API Error" 
\ No newline at end of file
+    assert str(exc_info.value) == "API Error" 
+
+def test_generate_inventory_region_group(mock_ec2_client, sample_instances, tmp_path):
+    """Test that hosts are grouped by region."""
+    mock_ec2_client.return_value.describe_instances.return_value = sample_instances
+    
+    output_file = tmp_path / "inventory.json"
+    AWSInventoryGenerator('us-west-2').generate_inventory(str(output_file))
+    
+    with open(output_file) as f:
+        inventory = json.load(f)
+    
+    region_hosts = inventory['all']['children']['us_west_2']['hosts']
+    assert set(region_hosts) == {'i-1234567890abcdef0', 'i-0987654321fedcba0'}
+
+def test_resolve_regions_list():
+    """Test resolving a comma-separated region list."""
+    assert resolve_regions('us-west-2, eu-west-1,us-west-2') == ['us-west-2', 'eu-west-1']
+
+def test_resolve_regions_all(mock_ec2_client):
+    """Test resolving all enabled regions."""
+    mock_ec2_client.return_value.describe_regions.return_value = {
+        'Regions': [{'RegionName': 'us-west-2'}, {'RegionName': 'eu-west-1'}]
+    }
+    
+    assert resolve_regions('all') == ['eu-west-1', 'us-west-2']
+
+def test_generate_multi_region_inventory(mock_ec2_client, sample_instances, tmp_path):
+    """Test merging several regions into one inventory."""
+    clients = {}
+    
+    def client_for_region(service, region_name, **kwargs):
+        client = clients.setdefault(region_name, Mock())
+        page = {'Reservations': [{'Instances': [
+            dict(instance, InstanceId=f"{instance['InstanceId']}-{region_name}")
+            for instance in sample_instances['Reservations'][0]['Instances']
+        ]}]}
+        client.describe_instances.return_value = page
+        return client
+    
+    mock_ec2_client.side_effect = client_for_region
+    
+    output_file = tmp_path / "inventory.json"
+    generate_multi_region_inventory(['us-west-2', 'eu-west-1'], str(output_file), max_workers=2)
+    
+    with open(output_file) as f:
+        inventory = json.load(f)
+    
+    assert len(inventory['all']['hosts']) == 4
+    assert set(inventory['all']['children']['eu_west_1']['hosts']) == {
+        'i-1234567890abcdef0-eu-west-1', 'i-0987654321fedcba0-eu-west-1'
+    }
+    assert len(inventory['all']['children']['webservers']['hosts']) == 2
+
+def test_generate_multi_region_inventory_region_failure(mock_ec2_client, tmp_path):
+    """Test that a failing region fails the sweep without writing a partial file."""
+    mock_ec2_client.return_value.describe_instances.side_effect = Exception("API Error")
+    
+    output_file = tmp_path / "inventory.json"
+    with pytest.raises(Exception) as exc_info:
+        generate_multi_region_inventory(['us-west-2', 'eu-west-1'], str(output_file))
+    
+    assert type(exc_info.value).__name__ == 'InventoryError'
+    assert 'eu-west-1' in str(exc_info.value)
+    assert not output_file.exists()
+
+def test_get_instances_cached(mock_ec2_client, sample_instances, tmp_path):
+    """Test that a fresh cache entry is served without calling the API."""
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.return_value = sample_instances
+    cache = InventoryCache(str(tmp_path / "cache"), max_age=60)
+    
+    first = AWSInventoryGenerator('us-west-2', cache=cache).get_instances()
+    second = AWSInventoryGenerator('us-west-2', cache=cache).get_instances()
+    
+    assert second == first
+    assert describe_instances.call_count == 1
+
+def test_get_instances_refresh(mock_ec2_client, sample_instances, tmp_path):
+    """Test that refresh bypasses a fresh cache entry."""
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.return_value = sample_instances
+    cache = InventoryCache(str(tmp_path / "cache"), max_age=60)
+    
+    AWSInventoryGenerator('us-west-2', cache=cache).get_instances()
+    AWSInventoryGenerator('us-west-2', cache=cache, refresh=True).get_instances()
+    
+    assert describe_instances.call_count == 2
+
+def test_generate_inventory_delta(mock_ec2_client, sample_instances, tmp_path):
+    """Test writing a delta against the previous inventory file."""
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.return_value = sample_instances
+    output_file = tmp_path / "inventory.json"
+    generator = AWSInventoryGenerator('us-west-2')
+    
+    generator.generate_inventory(str(output_file))
+    sample_instances['Reservations'][0]['Instances'][1]['InstanceType'] = 't2.medium'
+    generator.generate_inventory(str(output_file), delta=True)
+    
+    with open(tmp_path / "inventory.delta.json") as f:
+        delta = json.load(f)
+    
+    assert delta['added'] == []
+    assert delta['removed'] == []
+    assert delta['changed'] == {'i-0987654321fedcba0': ['instance_type']}
+
+def test_generate_inventory_no_instances_keeps_file(mock_ec2_client, tmp_path):
+    """Test that a failed generation leaves the previous inventory in place."""
+    mock_ec2_client.return_value.describe_instances.return_value = {'Reservations': []}
+    output_file = tmp_path / "inventory.json"
+    output_file.write_text('{"all": {"hosts": {}}}')
+    
+    with pytest.raises(Exception):
+        AWSInventoryGenerator('us-west-2').generate_inventory(str(output_file))
+    
+    assert output_file.read_text() == '{"all": {"hosts": {}}}'
+    assert [p.name for p in tmp_path.iterdir()] == ['inventory.json']
+
+def test_write_dynamic_inventory(mock_ec2_client, sample_instances):
+    """Test the dynamic inventory --list output."""
+    mock_ec2_client.return_value.describe_instances.return_value = sample_instances
+    
+    stream = io.StringIO()
+    host_count = write_dynamic_inventory(['us-west-2'], stream)
+    inventory = json.loads(stream.getvalue())
+    
+    assert host_count == 2
+    assert inventory['_meta']['hostvars']['i-0987654321fedcba0']['ansible_host'] == '10.0.0.2'
+    assert inventory['webservers']['hosts'] == ['i-1234567890abcdef0']
+    assert set(inventory['us_west_2']['hosts']) == {'i-1234567890abcdef0', 'i-0987654321fedcba0'}
+    assert 'webservers' in inventory['all']['children']
+
+def test_find_host_vars(mock_ec2_client, sample_instances):
+    """Test the dynamic inventory --host output."""
+    mock_ec2_client.return_value.describe_instances.return_value = sample_instances
+    
+    assert find_host_vars(['us-west-2'], 'i-1234567890abcdef0')['ansible_host'] == '54.0.0.1'
+    assert find_host_vars(['us-west-2'], 'i-unknown') == {}
+    # Only the requested instance is listed
+    filters = mock_ec2_client.return_value.describe_instances.call_args.kwargs['Filters']
+    assert {'Name': 'instance-id', 'Values': ['i-unknown']} in filters
+
+def test_find_host_vars_cached(mock_ec2_client, sample_instances, tmp_path):
+    """Test that --host is answered from a fresh cached listing without calling the API."""
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.return_value = sample_instances
+    cache = InventoryCache(str(tmp_path / "cache"), max_age=60)
+    AWSInventoryGenerator('us-west-2', cache=cache).get_instances()
+    
+    host_vars = find_host_vars(['us-west-2'], 'i-0987654321fedcba0', cache=cache)
+    
+    assert host_vars['ansible_host'] == '10.0.0.2'
+    assert describe_instances.call_count == 1
+
+def test_dynamic_inventory_list_failure_writes_nothing():
+    """Test that a failed --list leaves no partial document on stdout."""
+    def write_partial(regions, stream, **kwargs):
+        stream.write('{"_meta": {"hostvars": {')
+        raise CloudProviderError("eu-west-1 failed")
+    
+    with patch.dict('os.environ', {'INFRA_INVENTORY_REGIONS': 'us-west-2',
+                                   'INFRA_INVENTORY_MAX_AGE': '0'}), \
+            patch('python.src.inventory.aws_inventory.write_dynamic_inventory', write_partial), \
+            patch('sys.stdout', new_callable=io.StringIO) as stdout:
+        assert dynamic_inventory_main(['--list']) == 1
+    
+    assert stdout.getvalue() == ''
+
+def test_generate_inventory_keyed_groups(mock_ec2_client, sample_instances, tmp_path):
+    """Test grouping hosts by additional keys."""
+    mock_ec2_client.return_value.describe_instances.return_value = sample_instances
+    
+    output_file = tmp_path / "inventory.json"
+    generate_aws_inventory(
+        'us-west-2', str(output_file), group_by=['instance_type', 'availability_zone=az']
+    )
+    
+    with open(output_file) as f:
+        children = json.load(f)['all']['children']
+    
+    assert list(children['instance_type_t2_micro']['hosts']) == ['i-1234567890abcdef0']
+    assert list(children['instance_type_t2_small']['hosts']) == ['i-0987654321fedcba0']
+    assert list(children['az_us_west_2a']['hosts']) == ['i-1234567890abcdef0']
+
+def test_get_instances_retries_throttling(mock_ec2_client, sample_instances):
+    """Test that throttled describe calls are retried."""
+    throttled = ClientError(
+        {'Error': {'Code': 'RequestLimitExceeded', 'Message': 'Request limit exceeded.'}},
+        'DescribeInstances'
+    )
+    describe_instances = mock_ec2_client.return_value.describe_instances
+    describe_instances.side_effect = [throttled, sample_instances]
+    
+    with patch('time.sleep'):
+        instances = AWSInventoryGenerator('us-west-2').get_instances()
+    
+    assert len(instances) == 2
+    assert describe_instances.call_count == 2
@@ -14,7 +14,7 @@ from typing import Dict, List
 from botocore.exceptions import ClientError
 from python.src.utils.ssh_manager import SSHManager
 from python.src.inventory.aws_inventory import AWSInventoryGenerator
-from python.src.utils.exceptions import SSHManagerError, CloudProviderError
+from python.src.utils.exceptions import CloudProviderError
 
 # Test configuration
 TEST_KEY_NAME = "test-infra-key"
@@ -117,20 +117,15 @@ class TestEnvironment:
         except OSError:
             pass
             
-    def _wait_for_ssh(self, host: str, max_retries: int = 30, delay: int = 10):
+    def _wait_for_ssh(self, host: str, timeout: int = 300):
         """Wait for SSH to be available on the instance."""
-        for i in range(max_retries):
-            try:
-                if self.ssh_manager.verify_connectivity(
-                    host=host,
-                    user='ubuntu',
-                    key_name=self.key_pair_name
-                ):
-                    return
-            except SSHManagerError:
-                pass
-            time.sleep(delay)
-        raise TimeoutError(f"SSH not available after {max_retries * delay} seconds")
+        result = self.ssh_manager.wait_for_ssh(
+            [(host, 'ubuntu')],
+            key_name=self.key_pair_name,
+            timeout=timeout
+        )[host]
+        if not result.ready:
+            raise TimeoutError(f"SSH not available after {timeout} seconds: {result.error}")
 
 @pytest.fixture(scope="module")
 def test_env():
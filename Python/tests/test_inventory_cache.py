@@ -0,0 +1,71 @@
+"""
+Unit tests for the inventory cache.
+"""
+
+import os
+import time
+import pytest
+from unittest.mock import patch
+from python.src.inventory.cache import InventoryCache
+
+@pytest.fixture
+def cache(tmp_path):
+    """Create InventoryCache instance with temporary directory."""
+    return InventoryCache(str(tmp_path / "cache"), max_age=60)
+
+@pytest.fixture
+def sample_instances():
+    """Sample instance information dictionaries."""
+    return [
+        {'id': 'i-1234567890abcdef0', 'type': 't2.micro', 'tags': {'Role': 'webserver'}},
+        {'id': 'i-0987654321fedcba0', 'type': 't2.small', 'tags': {}}
+    ]
+
+def test_make_key_depends_on_inputs():
+    """Test that keys differ by account, region and filters."""
+    filters = [{'Name': 'instance-state-name', 'Values': ['running']}]
+    key = InventoryCache.make_key('account', 'us-west-2', filters)
+    
+    assert key == InventoryCache.make_key('account', 'us-west-2', filters)
+    assert key != InventoryCache.make_key('other', 'us-west-2', filters)
+    assert key != InventoryCache.make_key('account', 'eu-west-1', filters)
+    assert key != InventoryCache.make_key('account', 'us-west-2', [])
+
+def test_make_key_depends_on_format_version():
+    """Test that entries written in another format are never looked up."""
+    key = InventoryCache.make_key('account', 'us-west-2', [])
+    
+    with patch('python.src.inventory.cache.CACHE_FORMAT_VERSION', 1):
+        assert key != InventoryCache.make_key('account', 'us-west-2', [])
+
+def test_store_and_load(cache, sample_instances):
+    """Test round-tripping instances through the cache."""
+    with cache.writer('key') as write_instance:
+        for instance in sample_instances:
+            write_instance(instance)
+    
+    assert list(cache.load('key')) == sample_instances
+
+def test_load_missing(cache):
+    """Test loading a key that was never stored."""
+    assert cache.load('missing') is None
+
+def test_load_expired(cache, sample_instances):
+    """Test that entries older than max_age are ignored."""
+    with cache.writer('key') as write_instance:
+        write_instance(sample_instances[0])
+    
+    stale = time.time() - 120
+    os.utime(os.path.join(cache.cache_dir, 'key.jsonl'), (stale, stale))
+    
+    assert cache.load('key') is None
+
+def test_writer_discards_partial_entry(cache, sample_instances):
+    """Test that a failed write leaves no entry behind."""
+    with pytest.raises(RuntimeError):
+        with cache.writer('key') as write_instance:
+            write_instance(sample_instances[0])
+            raise RuntimeError("API Error")
+    
+    assert cache.load('key') is None
+    assert os.listdir(cache.cache_dir) == []
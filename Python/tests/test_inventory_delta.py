@@ -0,0 +1,79 @@
+"""
+Unit tests for inventory delta computation.
+"""
+
+import os
+import pytest
+from python.src.inventory.delta import (
+    InventoryDiffer,
+    delta_path,
+    load_delta_limit,
+    load_previous_inventory,
+    write_delta
+)
+
+@pytest.fixture
+def previous_inventory():
+    """Previous inventory with one webserver and two other hosts."""
+    return {
+        'all': {
+            'hosts': {
+                'i-web': {'ansible_host': '54.0.0.1', 'instance_type': 't2.micro'},
+                'i-db': {'ansible_host': '10.0.0.2', 'instance_type': 't2.small'},
+                'i-old': {'ansible_host': '10.0.0.3', 'instance_type': 't2.small'}
+            },
+            'children': {
+                'webservers': {'hosts': {'i-web': {}}}
+            }
+        }
+    }
+
+def test_differ_detects_changes(previous_inventory):
+    """Test detection of added, removed and changed hosts."""
+    differ = InventoryDiffer(previous_inventory)
+    differ.observe('i-web', {'ansible_host': '54.0.0.9', 'instance_type': 't2.micro'}, ['webservers'])
+    differ.observe('i-db', {'ansible_host': '10.0.0.2', 'instance_type': 't2.small'}, ['webservers'])
+    differ.observe('i-new', {'ansible_host': '10.0.0.4', 'instance_type': 't3.large'}, [])
+    
+    delta = differ.result()
+    
+    assert delta['added'] == ['i-new']
+    assert delta['removed'] == ['i-old']
+    assert delta['changed'] == {'i-web': ['ansible_host'], 'i-db': ['groups']}
+    assert delta['unchanged'] == 0
+
+def test_differ_without_previous():
+    """Test that every host is added when there is no previous inventory."""
+    differ = InventoryDiffer(None)
+    differ.observe('i-web', {'ansible_host': '54.0.0.1'}, [])
+    
+    delta = differ.result()
+    
+    assert delta['added'] == ['i-web']
+    assert delta['removed'] == []
+
+def test_delta_path():
+    """Test naming of the delta file."""
+    assert delta_path('inventories/aws.json') == 'inventories/aws.delta.json'
+
+def test_load_previous_inventory_missing(tmp_path):
+    """Test loading a previous inventory that does not exist."""
+    assert load_previous_inventory(str(tmp_path / "missing.json")) is None
+
+def test_load_delta_limit(tmp_path):
+    """Test limiting configuration to added and changed hosts."""
+    path = str(tmp_path / "aws.delta.json")
+    write_delta({'added': ['i-new'], 'removed': ['i-old'], 'changed': {'i-web': ['ansible_host']}}, path)
+    
+    assert load_delta_limit(path) == ['i-new', 'i-web']
+
+def test_write_delta_keeps_previous_file_on_error(tmp_path):
+    """Test that a failed write leaves the previous delta intact and no temporary file."""
+    path = str(tmp_path / "aws.delta.json")
+    write_delta({'added': ['i-new'], 'removed': [], 'changed': {}}, path)
+    
+    with pytest.raises(Exception):
+        write_delta({'added': ['i-other', object()], 'removed': [], 'changed': {}}, path)
+    
+    assert load_delta_limit(path) == ['i-new']
+    assert os.listdir(tmp_path) == ['aws.delta.json']
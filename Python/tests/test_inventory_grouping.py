@@ -0,0 +1,54 @@
+"""
+Unit tests for inventory grouping.
+"""
+
+import pytest
+from python.src.inventory.grouping import InventoryGrouper, KeyedGroup, sanitize_group_name
+
+@pytest.fixture
+def instance():
+    """Sample instance information dictionary."""
+    return {
+        'id': 'i-1234567890abcdef0',
+        'type': 't2.micro',
+        'availability_zone': 'us-west-2a',
+        'vpc_id': 'vpc-0abc',
+        'region': 'us-west-2',
+        'tags': {'Role': 'webserver', 'Env': 'prod'}
+    }
+
+def test_default_groups(instance):
+    """Test the region and webservers groups."""
+    grouper = InventoryGrouper()
+    
+    assert grouper.groups_for(instance, 'us-west-2') == ['us_west_2', 'webservers']
+    assert grouper.declared_groups(['us-west-2', 'eu-west-1']) == ['webservers', 'us_west_2', 'eu_west_1']
+
+def test_keyed_groups(instance):
+    """Test groups keyed by tags and instance attributes."""
+    grouper = InventoryGrouper(['tag:Env', 'availability_zone=az', 'vpc_id', 'tag:Missing'])
+    
+    assert grouper.groups_for(instance, 'us-west-2') == [
+        'us_west_2', 'webservers', 'tag_Env_prod', 'az_us_west_2a', 'vpc_id_vpc_0abc'
+    ]
+
+def test_keyed_group_reuses_names(instance):
+    """Test that group names are computed once per distinct value."""
+    keyed_group = KeyedGroup('instance_type')
+    
+    first = keyed_group.group_for(instance)
+    second = keyed_group.group_for(dict(instance))
+    
+    assert first == 'instance_type_t2_micro'
+    assert first is second
+
+def test_invalid_group_key():
+    """Test that unsupported group keys are rejected."""
+    with pytest.raises(Exception) as exc_info:
+        InventoryGrouper(['hostname'])
+    
+    assert 'hostname' in str(exc_info.value)
+
+def test_sanitize_group_name():
+    """Test replacing characters that are invalid in group names."""
+    assert sanitize_group_name('tag_Team_web-ops.eu') == 'tag_Team_web_ops_eu'
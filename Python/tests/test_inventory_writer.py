@@ -0,0 +1,94 @@
+"""
+Unit tests for the streaming inventory writer.
+"""
+
+import io
+import json
+import os
+import pytest
+from python.src.inventory.writer import InventoryWriter
+
+@pytest.fixture
+def hosts():
+    """Sample host entries with their groups."""
+    return [
+        ('i-1234567890abcdef0', {'ansible_host': '54.0.0.1', 'instance_type': 't2.micro'}, ['webservers']),
+        ('i-0987654321fedcba0', {'ansible_host': '10.0.0.2', 'instance_type': 't2.small'}, [])
+    ]
+
+def _write(output_file, hosts, **kwargs):
+    """Write hosts to an inventory file."""
+    with InventoryWriter(str(output_file), groups=['webservers', 'us_west_2'], **kwargs) as writer:
+        for host_id, host_vars, groups in hosts:
+            writer.add_host(host_id, host_vars, groups + ['us_west_2'])
+    return writer
+
+def test_write_inventory(tmp_path, hosts):
+    """Test that the streamed file matches the equivalent JSON document."""
+    output_file = tmp_path / "inventory.json"
+    _write(output_file, hosts)
+    
+    expected = {
+        'all': {
+            'hosts': {host_id: host_vars for host_id, host_vars, _ in hosts},
+            'children': {
+                'webservers': {'hosts': {'i-1234567890abcdef0': {}}},
+                'us_west_2': {'hosts': {'i-1234567890abcdef0': {}, 'i-0987654321fedcba0': {}}}
+            }
+        }
+    }
+    assert output_file.read_text() == json.dumps(expected, indent=2) + '\n'
+
+def test_write_compact_inventory(tmp_path, hosts):
+    """Test compact output."""
+    output_file = tmp_path / "inventory.json"
+    _write(output_file, hosts, compact=True)
+    
+    content = output_file.read_text()
+    assert '\n' not in content
+    assert json.loads(content)['all']['hosts']['i-0987654321fedcba0']['ansible_host'] == '10.0.0.2'
+
+def test_write_empty_inventory(tmp_path):
+    """Test that an inventory without hosts is valid JSON."""
+    output_file = tmp_path / "inventory.json"
+    with InventoryWriter(str(output_file)):
+        pass
+    
+    assert json.loads(output_file.read_text()) == {'all': {'hosts': {}, 'children': {}}}
+
+def test_write_failure_keeps_previous_file(tmp_path, hosts):
+    """Test that an error while writing leaves the previous file untouched."""
+    output_file = tmp_path / "inventory.json"
+    output_file.write_text('previous')
+    
+    with pytest.raises(RuntimeError):
+        with InventoryWriter(str(output_file)) as writer:
+            writer.add_host(*hosts[0])
+            raise RuntimeError("API Error")
+    
+    assert output_file.read_text() == 'previous'
+    assert os.listdir(tmp_path) == ['inventory.json']
+
+def test_write_keeps_file_mode(tmp_path, hosts):
+    """Test that replacing a file keeps its permissions."""
+    output_file = tmp_path / "inventory.json"
+    output_file.write_text('previous')
+    os.chmod(output_file, 0o640)
+    
+    _write(output_file, hosts)
+    
+    assert oct(os.stat(output_file).st_mode)[-3:] == '640'
+
+def test_write_script_format(hosts):
+    """Test the dynamic inventory script format on a stream."""
+    stream = io.StringIO()
+    with InventoryWriter(None, groups=['webservers'], script_format=True, stream=stream) as writer:
+        for host_id, host_vars, groups in hosts:
+            writer.add_host(host_id, host_vars, groups)
+    
+    inventory = json.loads(stream.getvalue())
+    
+    assert inventory['_meta']['hostvars']['i-1234567890abcdef0']['ansible_host'] == '54.0.0.1'
+    assert inventory['webservers'] == {'hosts': ['i-1234567890abcdef0']}
+    assert inventory['all'] == {'children': ['ungrouped', 'webservers']}
+    assert not stream.closed
@@ -0,0 +1,192 @@
+"""
+Unit tests for known_hosts management.
+"""
+
+import os
+import hmac
+import base64
+import hashlib
+import pytest
+from unittest.mock import patch
+from python.src.utils import known_hosts as known_hosts_module
+from python.src.utils.known_hosts import KnownHostsFile, known_hosts_entry
+
+RSA_KEY = "AAAAB3NzaC1yc2EAAAADAQABAAABAQ"
+ED25519_KEY = "AAAAC3NzaC1lZDI1NTE5AAAAIOld"
+NEW_ED25519_KEY = "AAAAC3NzaC1lZDI1NTE5AAAAINew"
+
+@pytest.fixture
+def known_hosts_path(tmp_path):
+    """Path of a known_hosts file in a temporary directory."""
+    return os.path.join(tmp_path, 'known_hosts')
+
+def _hashed(host, salt=b'0123456789abcdef0123'):
+    """Hash a host name the way HashKnownHosts does."""
+    digest = hmac.new(salt, host.encode(), hashlib.sha1).digest()
+    return f"|1|{base64.b64encode(salt).decode()}|{base64.b64encode(digest).decode()}"
+
+def _read_lines(path):
+    with open(path) as f:
+        return f.read().splitlines()
+
+def test_known_hosts_entry():
+    """Test host formatting for default and custom ports."""
+    assert known_hosts_entry('web-1') == 'web-1'
+    assert known_hosts_entry('web-1', 2222) == '[web-1]:2222'
+
+def test_merge_creates_file(known_hosts_path):
+    """Test merging keys into a new known_hosts file."""
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    added, replaced = known_hosts.merge([
+        f"web-1 ssh-ed25519 {ED25519_KEY}",
+        f"web-1 ssh-rsa {RSA_KEY}",
+        "# web-1:22 SSH-2.0-OpenSSH_9.6"
+    ])
+    
+    assert (added, replaced) == (2, 0)
+    assert _read_lines(known_hosts_path) == [
+        f"web-1 ssh-ed25519 {ED25519_KEY}",
+        f"web-1 ssh-rsa {RSA_KEY}"
+    ]
+    assert oct(os.stat(known_hosts_path).st_mode)[-3:] == '600'
+
+def test_merge_deduplicates(known_hosts_path):
+    """Test that rescanning a host replaces its keys instead of appending."""
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"web-1,10.0.1.10 ssh-ed25519 {ED25519_KEY}\n")
+        f.write(f"web-1 ssh-ed25519 {ED25519_KEY}\n")
+        f.write(f"@cert-authority *.example.com ssh-rsa {RSA_KEY}\n")
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    added, replaced = known_hosts.merge([f"web-1 ssh-ed25519 {NEW_ED25519_KEY}"])
+    
+    assert (added, replaced) == (0, 1)
+    assert _read_lines(known_hosts_path) == [
+        f"10.0.1.10 ssh-ed25519 {ED25519_KEY}",
+        f"web-1 ssh-ed25519 {NEW_ED25519_KEY}",
+        f"@cert-authority *.example.com ssh-rsa {RSA_KEY}"
+    ]
+
+def test_merge_keeps_line_order(known_hosts_path):
+    """Test that only changed entries are rewritten and every other line keeps its place."""
+    original = [
+        "# bastion",
+        f"bastion,10.0.0.5 ssh-ed25519 {ED25519_KEY}",
+        "",
+        f"@revoked * ssh-rsa {RSA_KEY}",
+        f"web-1,10.0.1.10   ssh-ed25519 {ED25519_KEY} web-1 key",
+        f"web-2 ssh-rsa {RSA_KEY}",
+    ]
+    with open(known_hosts_path, 'w') as f:
+        f.write('\n'.join(original) + '\n')
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    added, replaced = known_hosts.merge([
+        f"web-1 ssh-ed25519 {NEW_ED25519_KEY}",
+        f"web-2 ssh-rsa {RSA_KEY}",
+        f"web-3 ssh-rsa {RSA_KEY}"
+    ])
+    
+    assert (added, replaced) == (1, 1)
+    assert _read_lines(known_hosts_path) == original[:4] + [
+        f"10.0.1.10 ssh-ed25519 {ED25519_KEY} web-1 key",
+        f"web-1 ssh-ed25519 {NEW_ED25519_KEY}",
+        f"web-2 ssh-rsa {RSA_KEY}",
+        f"web-3 ssh-rsa {RSA_KEY}"
+    ]
+
+def test_merge_unchanged_keeps_file(known_hosts_path):
+    """Test that merging known keys doesn't rewrite the file."""
+    known_hosts = KnownHostsFile(known_hosts_path)
+    known_hosts.merge([f"web-1 ssh-ed25519 {ED25519_KEY}"])
+    mtime = os.stat(known_hosts_path).st_mtime_ns
+    
+    assert known_hosts.merge([f"web-1 ssh-ed25519 {ED25519_KEY}"]) == (0, 0)
+    assert os.stat(known_hosts_path).st_mtime_ns == mtime
+
+def test_merge_replaces_hashed_entry(known_hosts_path):
+    """Test that a hashed entry for a rescanned host is updated and stays hashed."""
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"{_hashed('web-1')} ssh-ed25519 {ED25519_KEY}\n")
+        f.write(f"{_hashed('web-2')} ssh-ed25519 {ED25519_KEY}\n")
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    assert known_hosts.merge([f"web-1 ssh-ed25519 {NEW_ED25519_KEY}"]) == (0, 1)
+    
+    assert _read_lines(known_hosts_path) == [
+        f"{_hashed('web-1')} ssh-ed25519 {NEW_ED25519_KEY}",
+        f"{_hashed('web-2')} ssh-ed25519 {ED25519_KEY}"
+    ]
+
+def test_merge_unchanged_hashed_entry(known_hosts_path):
+    """Test that a known key of a hashed host is neither added nor rewritten."""
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"{_hashed('web-1')} ssh-ed25519 {ED25519_KEY}\n")
+    mtime = os.stat(known_hosts_path).st_mtime_ns
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    assert known_hosts.merge([f"web-1 ssh-ed25519 {ED25519_KEY}"]) == (0, 0)
+    assert os.stat(known_hosts_path).st_mtime_ns == mtime
+
+def test_lookup(known_hosts_path):
+    """Test looking up plain and hashed entries."""
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"[web-1]:2222 ssh-ed25519 {ED25519_KEY}\n")
+        f.write(f"{_hashed('web-2')} ssh-rsa {RSA_KEY}\n")
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    assert known_hosts.lookup('web-1', 2222) == {'ssh-ed25519': ED25519_KEY}
+    assert known_hosts.lookup('web-2') == {'ssh-rsa': RSA_KEY}
+    assert known_hosts.lookup('web-1') == {}
+
+def test_lookup_hashes_host_once_per_salt(known_hosts_path):
+    """Test that hashed entries aren't rehashed for every lookup."""
+    with open(known_hosts_path, 'w') as f:
+        for index in range(20):
+            f.write(f"{_hashed(f'web-{index}')} ssh-ed25519 {ED25519_KEY}\n")
+        f.write(f"{_hashed('db-1', salt=b'another salt 0123456')} ssh-rsa {RSA_KEY}\n")
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    with patch.object(known_hosts_module, '_hash_host',
+                      wraps=known_hosts_module._hash_host) as hash_host:
+        assert known_hosts.lookup('web-7') == {'ssh-ed25519': ED25519_KEY}
+        assert known_hosts.lookup('db-1') == {'ssh-rsa': RSA_KEY}
+        assert hash_host.call_count == 4
+        
+        assert known_hosts.lookup('web-7') == {'ssh-ed25519': ED25519_KEY}
+        assert known_hosts.merge([f"web-7 ssh-ed25519 {ED25519_KEY}"]) == (0, 0)
+        assert hash_host.call_count == 4
+
+def test_lookup_reloads_changed_file(known_hosts_path):
+    """Test that external changes to the file are picked up."""
+    known_hosts = KnownHostsFile(known_hosts_path)
+    assert known_hosts.lookup('web-1') == {}
+    
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"web-1 ssh-ed25519 {ED25519_KEY}\n")
+    
+    assert known_hosts.lookup('web-1') == {'ssh-ed25519': ED25519_KEY}
+
+def test_remove(known_hosts_path):
+    """Test removing every key of a host."""
+    known_hosts = KnownHostsFile(known_hosts_path)
+    known_hosts.merge([
+        f"web-1 ssh-ed25519 {ED25519_KEY}",
+        f"web-1 ssh-rsa {RSA_KEY}",
+        f"web-2 ssh-ed25519 {ED25519_KEY}"
+    ])
+    
+    assert known_hosts.remove(['web-1', 'missing']) == 2
+    assert _read_lines(known_hosts_path) == [f"web-2 ssh-ed25519 {ED25519_KEY}"]
+
+def test_remove_hashed_and_shared_entries(known_hosts_path):
+    """Test removing a host from hashed and multi-host entries."""
+    with open(known_hosts_path, 'w') as f:
+        f.write(f"{_hashed('web-1')} ssh-rsa {RSA_KEY}\n")
+        f.write(f"web-1,10.0.1.10 ssh-ed25519 {ED25519_KEY}\n")
+    known_hosts = KnownHostsFile(known_hosts_path)
+    
+    assert known_hosts.remove(['web-1']) == 2
+    assert _read_lines(known_hosts_path) == [f"10.0.1.10 ssh-ed25519 {ED25519_KEY}"]
+    assert known_hosts.lookup('web-1') == {}
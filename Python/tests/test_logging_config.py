@@ -0,0 +1,177 @@
+"""
+Unit tests for logging configuration.
+"""
+
+import io
+import os
+import sys
+import json
+import queue
+import threading
+import logging
+import pytest
+from python.src.utils import logging_config
+from python.src.utils.logging_config import DroppingQueueHandler
+
+@pytest.fixture
+def root_logger():
+    """Restore the root logger's handlers and level after a test."""
+    root = logging.getLogger()
+    handlers, level = list(root.handlers), root.level
+    yield root
+    logging_config.shutdown_logging()
+    for handler in list(root.handlers):
+        if handler not in handlers:
+            root.removeHandler(handler)
+            handler.close()
+    root.setLevel(level)
+
+def _record(level, message):
+    return logging.LogRecord('test', level, __file__, 1, message, None, None)
+
+def test_queued_logging_writes_file(tmp_path, root_logger):
+    """Test that queued records reach the log file once logging is shut down."""
+    log_file = os.path.join(tmp_path, 'logs', 'app.log')
+    logging_config.setup_logging(log_file, use_queue=True)
+    
+    logging.getLogger('test.queue').info("queued %s", "message")
+    stats = logging_config.get_log_queue_stats()
+    logging_config.shutdown_logging()
+    
+    with open(log_file) as f:
+        assert 'INFO - queued message' in f.read()
+    assert stats['enqueued'] >= 1
+    assert stats['dropped'] == 0
+    assert logging_config.get_log_queue_stats() is None
+
+def test_shutdown_logging_with_full_queue(tmp_path, root_logger):
+    """Test that a saturated queue is flushed and the listener stopped."""
+    log_file = os.path.join(tmp_path, 'app.log')
+    logging_config.setup_logging(log_file, use_queue=True, queue_size=2)
+    listener = logging_config._queue_listener
+    
+    class GateHandler(logging.Handler):
+        """Handler that holds up the listener thread until released."""
+        def __init__(self):
+            super().__init__()
+            self.entered = threading.Event()
+            self.resume = threading.Event()
+        
+        def emit(self, record):
+            self.entered.set()
+            self.resume.wait(5)
+    gate = GateHandler()
+    listener.handlers = listener.handlers + (gate,)
+    
+    logger = logging.getLogger('test.full')
+    logger.info("holding the listener")
+    assert gate.entered.wait(5)
+    while not logging_config.get_log_queue_stats()['dropped']:
+        logger.info("filling the queue")
+    assert listener.queue.full()
+    
+    threading.Timer(0.2, gate.resume.set).start()
+    logging_config.shutdown_logging()
+    
+    assert listener._thread is None
+    assert logging_config.get_log_queue_stats() is None
+    with open(log_file) as f:
+        assert 'filling the queue' in f.read()
+
+def test_queue_handler_drops_low_priority_records():
+    """Test that a full queue drops and counts records below the drop level."""
+    handler = DroppingQueueHandler(queue.Queue(maxsize=1), drop_level=logging.WARNING)
+    
+    handler.handle(_record(logging.INFO, "kept"))
+    handler.handle(_record(logging.DEBUG, "dropped"))
+    handler.handle(_record(logging.INFO, "dropped"))
+    
+    stats = handler.stats()
+    assert stats['enqueued'] == 1
+    assert stats['dropped'] == 2
+    assert stats['dropped_by_level'] == {'DEBUG': 1, 'INFO': 1}
+    assert stats['high_water'] == 1
+    assert stats['capacity'] == 1
+
+def test_queue_handler_defers_formatting():
+    """Test that records are queued without being formatted."""
+    log_queue = queue.Queue()
+    handler = DroppingQueueHandler(log_queue)
+    record = logging.LogRecord('test', logging.INFO, __file__, 1, "value %s", ('x',), None)
+    
+    handler.handle(record)
+    
+    queued = log_queue.get_nowait()
+    assert queued.msg == "value %s"
+    assert queued.args == ('x',)
+
+class ExplodingValue:
+    """Field value that fails the test if it is rendered."""
+    
+    def __str__(self):
+        raise AssertionError("field rendered for a disabled level")
+
+def test_log_event_skips_disabled_levels(root_logger):
+    """Test that fields of disabled levels are never rendered."""
+    logger = logging.getLogger('test.lazy')
+    logger.setLevel(logging.INFO)
+    handler = logging.StreamHandler(io.StringIO())
+    logger.addHandler(handler)
+    
+    try:
+        logging_config.log_event(logger, logging.DEBUG, "Found instance", value=ExplodingValue())
+    finally:
+        logger.removeHandler(handler)
+        logger.setLevel(logging.NOTSET)
+    
+    assert handler.stream.getvalue() == ""
+
+def test_log_event_text_rendering(root_logger):
+    """Test that events render as text with key=value fields."""
+    logger = logging.getLogger('test.text')
+    stream = io.StringIO()
+    handler = logging.StreamHandler(stream)
+    logger.addHandler(handler)
+    
+    try:
+        logging_config.log_event(logger, logging.WARNING, "Found instance", instance_id='i-123')
+    finally:
+        logger.removeHandler(handler)
+    
+    assert stream.getvalue() == "Found instance: instance_id=i-123\n"
+
+def test_json_log_file(tmp_path, root_logger):
+    """Test that the JSON log format writes one object per line with fields."""
+    log_file = os.path.join(tmp_path, 'app.log')
+    logging_config.setup_logging(log_file, log_format='json')
+    logger = logging.getLogger('test.json')
+    
+    logging_config.log_event(logger, logging.INFO, "Found instance", instance_id='i-123', port=22)
+    logger.warning("plain %s", "message")
+    for handler in logging.getLogger().handlers:
+        handler.flush()
+    
+    with open(log_file) as f:
+        entries = [json.loads(line) for line in f]
+    assert entries[0]['message'] == "Found instance"
+    assert entries[0]['instance_id'] == 'i-123'
+    assert entries[0]['port'] == 22
+    assert entries[0]['level'] == 'INFO'
+    assert entries[0]['logger'] == 'test.json'
+    assert entries[1]['message'] == "plain message"
+
+def test_json_formatter_exception():
+    """Test that exceptions are included in JSON records."""
+    try:
+        raise ValueError("boom")
+    except ValueError:
+        record = logging.LogRecord('test', logging.ERROR, __file__, 1, "failed", None, sys.exc_info())
+    
+    entry = json.loads(logging_config.JSONFormatter().format(record))
+    
+    assert 'ValueError: boom' in entry['exception']
+
+def test_setup_logging_invalid_format(tmp_path):
+    """Test that unknown log formats are rejected."""
+    with pytest.raises(ValueError):
+        logging_config.setup_logging(os.path.join(tmp_path, 'app.log'), log_format='xml')
@@ -0,0 +1,95 @@
+"""
+Unit tests for the command-line entry point.
+"""
+
+import os
+import sys
+import json
+import subprocess
+
+# Modules the CLI must not load unless a command needs them
+OPTIONAL_MODULES = ('boto3', 'botocore', 'ansible_runner', 'asyncssh')
+
+STARTUP_SCRIPT = """
+import sys, json
+args, modules = json.loads(sys.argv[1]), json.loads(sys.argv[2])
+from python import main
+loaded_by_import = [name for name in modules if name in sys.modules]
+sys.argv = ['main.py'] + args
+try:
+    status = main.main()
+except SystemExit as e:
+    status = e.code
+print(json.dumps({
+    'status': status,
+    'imported': loaded_by_import,
+    'loaded': [name for name in modules if name in sys.modules]
+}), file=sys.stderr)
+"""
+
+def _run_cli(cwd, *args):
+    """Run the CLI in a fresh interpreter and report what it loaded."""
+    result = subprocess.run(
+        [sys.executable, '-c', STARTUP_SCRIPT, json.dumps(args), json.dumps(OPTIONAL_MODULES)],
+        cwd=cwd,
+        env=dict(os.environ, PYTHONPATH=os.pathsep.join(sys.path)),
+        capture_output=True,
+        text=True,
+        timeout=60
+    )
+    return json.loads(result.stderr.strip().splitlines()[-1])
+
+def test_help_starts_without_optional_modules(tmp_path):
+    """Test that importing the CLI and --help load no optional dependency or logging."""
+    report = _run_cli(tmp_path, '--help')
+    
+    assert report['status'] == 0
+    assert report['imported'] == []
+    assert report['loaded'] == []
+    # The log file is only created once a command runs
+    assert os.listdir(tmp_path) == []
+
+def test_configure_starts_without_optional_modules(tmp_path):
+    """Test that configure runs without loading an optional dependency it doesn't use."""
+    with open(os.path.join(tmp_path, 'inventory.delta.json'), 'w') as f:
+        json.dump({'added': [], 'removed': [], 'changed': []}, f)
+    
+    report = _run_cli(
+        tmp_path,
+        '--log-file', 'logs/infra.log',
+        'configure',
+        '--playbook', 'webserver.yml',
+        '--inventory', 'inventory.json',
+        '--changed-only', 'inventory.delta.json'
+    )
+    
+    assert report['status'] == 0
+    assert report['loaded'] == []
+    assert os.path.exists(os.path.join(tmp_path, 'logs', 'infra.log'))
+
+def test_ansible_config_rejects_tuning_arguments(tmp_path):
+    """Test that tuned settings can't be combined with --ansible-config, which ignores them."""
+    report = _run_cli(
+        tmp_path,
+        'configure',
+        '--playbook', 'webserver.yml',
+        '--inventory', 'inventory.json',
+        '--ansible-config', 'ansible.cfg',
+        '--no-pipelining'
+    )
+    
+    assert report['status'] == 2
+    assert os.listdir(tmp_path) == []
+
+def test_execution_arguments_must_be_positive(tmp_path):
+    """Test that --forks and --throttle below 1 are usage errors."""
+    for option in ('--forks', '--throttle'):
+        report = _run_cli(
+            tmp_path,
+            'configure',
+            '--playbook', 'webserver.yml',
+            '--inventory', 'inventory.json',
+            option, '0'
+        )
+        
+        assert report['status'] == 2
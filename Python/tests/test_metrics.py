@@ -0,0 +1,137 @@
+"""
+Unit tests for timing spans and metrics export.
+"""
+
+import os
+import logging
+import threading
+import pytest
+from concurrent.futures import ThreadPoolExecutor
+from python.src.utils import logging_config
+from python.src.utils.metrics import SpanRecorder, SpanStats, current_span, submit_in_context
+
+@pytest.fixture
+def recorder():
+    """Create an empty span recorder."""
+    return SpanRecorder()
+
+def test_span_stats_quantiles():
+    """Test count, percentiles and maximum of a series."""
+    stats = SpanStats()
+    for ms in range(1, 101):
+        stats.add(ms * 1_000_000, failed=ms == 100)
+    
+    summary = stats.summary()
+    assert summary['count'] == 100
+    assert summary['errors'] == 1
+    assert summary['p50'] == pytest.approx(0.050)
+    assert summary['p95'] == pytest.approx(0.095)
+    assert summary['max'] == pytest.approx(0.100)
+    assert summary['sum'] == pytest.approx(5.050)
+
+def test_nested_spans(recorder):
+    """Test that spans are keyed by their parent span."""
+    with recorder.span('inventory.generate') as outer:
+        with recorder.span('aws.describe_instances') as inner:
+            assert inner.parent is outer
+        with recorder.span('aws.describe_instances'):
+            pass
+    with recorder.span('aws.describe_instances'):
+        pass
+    
+    snapshot = recorder.snapshot()
+    assert snapshot[('inventory.generate', '')]['count'] == 1
+    assert snapshot[('aws.describe_instances', 'inventory.generate')]['count'] == 2
+    assert snapshot[('aws.describe_instances', '')]['count'] == 1
+    assert outer.duration >= inner.duration
+
+def test_span_records_failure(recorder):
+    """Test that a span closed by an exception is counted as an error."""
+    with pytest.raises(ValueError):
+        with recorder.span('ssh.check'):
+            raise ValueError("boom")
+    
+    assert recorder.snapshot()[('ssh.check', '')]['errors'] == 1
+
+def test_spans_in_threads_are_roots(recorder):
+    """Test that a new thread doesn't inherit the open span of another thread."""
+    def worker():
+        with recorder.span('ssh.check'):
+            pass
+    
+    with recorder.span('inventory.generate'):
+        thread = threading.Thread(target=worker)
+        thread.start()
+        thread.join()
+    
+    assert set(recorder.snapshot()) == {('inventory.generate', ''), ('ssh.check', '')}
+
+def test_submit_in_context(recorder):
+    """Test that calls submitted to a pool see the submitter's open span."""
+    def parent_name():
+        return current_span().name if current_span() else None
+    
+    with ThreadPoolExecutor(max_workers=1) as executor:
+        with recorder.span('inventory.generate'):
+            inside = submit_in_context(executor, parent_name).result()
+        plain = executor.submit(parent_name).result()
+    
+    assert (inside, plain) == ('inventory.generate', None)
+
+def test_render_prometheus(recorder):
+    """Test the Prometheus text format."""
+    with recorder.span('inventory.generate'):
+        with recorder.span('aws.describe_instances'):
+            pass
+    
+    text = recorder.render('prometheus')
+    labels = 'span="aws.describe_instances",parent="inventory.generate"'
+    assert "# TYPE infra_automation_span_duration_seconds summary" in text
+    assert f'infra_automation_span_duration_seconds{{{labels},quantile="0.95"}}' in text
+    assert f'infra_automation_span_duration_seconds_count{{{labels}}} 1' in text
+    assert f'infra_automation_span_max_seconds{{{labels}}}' in text
+    assert "# TYPE infra_automation_span_errors_total counter" in text
+    assert f'infra_automation_span_errors_total{{{labels}}} 0' in text
+    assert "# EOF" not in text
+
+def test_render_openmetrics(recorder):
+    """Test that the OpenMetrics format declares units and ends with EOF."""
+    with recorder.span('ssh.check'):
+        pass
+    
+    text = recorder.render('openmetrics')
+    assert "# UNIT infra_automation_span_duration_seconds seconds" in text
+    assert "# TYPE infra_automation_span_errors counter" in text
+    assert 'infra_automation_span_errors_total{span="ssh.check",parent=""} 0' in text
+    assert text.endswith("# EOF\n")
+
+def test_render_unsupported_format(recorder):
+    """Test that an unknown format is rejected."""
+    with pytest.raises(ValueError):
+        recorder.render('statsd')
+
+def test_export(recorder, tmp_path):
+    """Test writing the metrics textfile."""
+    with recorder.span('ssh.check'):
+        pass
+    path = os.path.join(tmp_path, 'textfile', 'infra.prom')
+    
+    recorder.export(path)
+    
+    with open(path) as f:
+        assert f.read() == recorder.render()
+    assert os.listdir(os.path.dirname(path)) == ['infra.prom']
+
+def test_logging_context_manager_records_span():
+    """Test that LoggingContextManager records a span under its stable name."""
+    logging_config.span_recorder.clear()
+    logger = logging.getLogger('test_metrics')
+    
+    with logging_config.LoggingContextManager(logger, "verifying host-1", span='ssh.verify') as ctx:
+        with logging_config.LoggingContextManager(logger, "checking host-1"):
+            pass
+    
+    snapshot = logging_config.span_recorder.snapshot()
+    assert snapshot[('ssh.verify', '')]['count'] == 1
+    assert snapshot[('checking host-1', 'ssh.verify')]['count'] == 1
+    assert ctx.duration > 0
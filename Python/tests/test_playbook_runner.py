@@ -0,0 +1,312 @@
+"""
+Unit tests for the parallel playbook runner.
+"""
+
+import os
+import sys
+import json
+import time
+import threading
+import pytest
+from unittest.mock import Mock, patch
+from python.src.utils.playbook_runner import (
+    ExecutionOptions,
+    HostEvent,
+    check_pipelining,
+    PlaybookRun,
+    count_inventory_hosts,
+    playbook_host_groups,
+    pair_runs,
+    parse_extra_vars,
+    parse_serial,
+    run_playbook,
+    run_playbooks
+)
+
+class FakeAnsibleRunner:
+    """Fake ansible_runner module that replays events per inventory."""
+    
+    def __init__(self):
+        self.calls = []
+        self.active = 0
+        self.max_active = 0
+        self._lock = threading.Lock()
+    
+    def run(self, **kwargs):
+        with self._lock:
+            self.calls.append(kwargs)
+            self.active += 1
+            self.max_active = max(self.max_active, self.active)
+        assert os.path.isdir(kwargs['private_data_dir'])
+        time.sleep(0.05)
+        
+        failed = 'broken' in kwargs['inventory']
+        events = [
+            {'event': 'playbook_on_start', 'event_data': {}},
+            {'event': 'playbook_on_play_start', 'event_data': {'play': 'Configure Web Server'}},
+            {'event': 'runner_on_ok', 'event_data': {'host': 'web-1', 'task': 'Install nginx',
+                                                      'res': {'changed': True}}},
+            # Second serial batch
+            {'event': 'playbook_on_play_start', 'event_data': {'play': 'Configure Web Server'}},
+            {'event': 'runner_on_ok', 'event_data': {'host': 'web-2', 'task': 'Install nginx',
+                                                      'res': {'changed': False}}},
+        ]
+        if failed:
+            events.append({'event': 'runner_on_unreachable',
+                           'event_data': {'host': 'web-3', 'task': 'Install nginx'}})
+        events.append({'event': 'playbook_on_stats', 'event_data': {}})
+        for event in events:
+            kwargs['event_handler'](event)
+        
+        with self._lock:
+            self.active -= 1
+        stats = {'ok': {'web-1': 1, 'web-2': 1}, 'changed': {'web-1': 1}}
+        if failed:
+            stats['dark'] = {'web-3': 1}
+        return Mock(status='failed' if failed else 'successful', rc=4 if failed else 0, stats=stats)
+
+@pytest.fixture
+def fake_runner():
+    """Install a fake ansible_runner module."""
+    runner = FakeAnsibleRunner()
+    with patch.dict(sys.modules, {'ansible_runner': runner}):
+        yield runner
+
+def test_parse_extra_vars():
+    """Test KEY=VALUE pairs and JSON objects."""
+    assert parse_extra_vars(['env=prod', '{"replicas": 3}', 'url=http://a/?b=c']) == {
+        'env': 'prod', 'replicas': 3, 'url': 'http://a/?b=c'
+    }
+    assert parse_extra_vars(['nginx_version=1.18.0 nginx_worker_processes=4', "motd='hello world'"]) == {
+        'nginx_version': '1.18.0', 'nginx_worker_processes': '4', 'motd': 'hello world'
+    }
+    assert parse_extra_vars(None) == {}
+
+def test_parse_extra_vars_invalid():
+    """Test rejection of malformed extra vars."""
+    for value in ('novalue', '=x', 'a=1 b', "a='1", '{"a": ', '{}}'):
+        with pytest.raises(Exception) as exc_info:
+            parse_extra_vars([value])
+        assert type(exc_info.value).__name__ == 'ValidationError'
+
+def test_pair_runs():
+    """Test broadcasting and positional pairing of playbooks and inventories."""
+    runs = pair_runs(['site.yml'], ['dev.yml', 'prod.yml'], ['web-1'], {'env': 'x'})
+    assert [(run.playbook, run.inventory) for run in runs] == [
+        ('site.yml', 'dev.yml'), ('site.yml', 'prod.yml')
+    ]
+    assert runs[0].limit == ['web-1']
+    assert runs[0].extra_vars is not runs[1].extra_vars
+    
+    runs = pair_runs(['a.yml', 'b.yml'], ['dev.yml'])
+    assert [run.inventory for run in runs] == ['dev.yml', 'dev.yml']
+    
+    runs = pair_runs(['a.yml', 'b.yml'], ['dev.yml', 'prod.yml'])
+    assert [(run.playbook, run.inventory) for run in runs] == [
+        ('a.yml', 'dev.yml'), ('b.yml', 'prod.yml')
+    ]
+    
+    with pytest.raises(Exception) as exc_info:
+        pair_runs(['a.yml', 'b.yml'], ['dev.yml', 'qa.yml', 'prod.yml'])
+    assert type(exc_info.value).__name__ == 'ValidationError'
+
+def test_run_playbook_streams_host_events(fake_runner):
+    """Test that host results are reported while the run is in progress."""
+    events = []
+    result = run_playbook(
+        PlaybookRun('site.yml', 'dev.yml', ['web-1', 'web-2'], {'env': 'dev'}),
+        on_event=events.append
+    )
+    
+    assert result.success is True
+    assert events == [
+        HostEvent('site.yml@dev.yml', 'web-1', 'Install nginx', 'changed'),
+        HostEvent('site.yml@dev.yml', 'web-2', 'Install nginx', 'ok'),
+    ]
+    kwargs = fake_runner.calls[0]
+    assert kwargs['playbook'] == os.path.abspath('site.yml')
+    assert kwargs['limit'] == 'web-1,web-2'
+    assert kwargs['extravars'] == {'env': 'dev'}
+    assert kwargs['quiet'] is True
+    # The private data directory is removed after the run
+    assert not os.path.exists(kwargs['private_data_dir'])
+    assert [(timing.play, timing.hosts) for timing in result.batches] == [
+        ('Configure Web Server', 1), ('Configure Web Server', 1)
+    ]
+
+def test_parse_serial():
+    """Test parsing serial batch sizes."""
+    assert parse_serial('1, 10%,100%') == [1, '10%', '100%']
+    for value in ('0', '0%', '101%', 'ten', '5,'):
+        with pytest.raises(Exception) as exc_info:
+            parse_serial(value)
+        assert type(exc_info.value).__name__ == 'ValidationError'
+
+def test_count_inventory_hosts(tmp_path):
+    """Test counting the hosts of file and script format inventories."""
+    inventory = os.path.join(tmp_path, 'inventory.json')
+    with open(inventory, 'w') as f:
+        json.dump({'all': {'hosts': {'i-1': {}, 'i-2': {}}, 'children': {}}}, f)
+    script_inventory = os.path.join(tmp_path, 'script.json')
+    with open(script_inventory, 'w') as f:
+        json.dump({'_meta': {'hostvars': {'i-1': {}}}, 'webservers': {'hosts': ['i-1']}}, f)
+    ini_inventory = os.path.join(tmp_path, 'hosts.ini')
+    with open(ini_inventory, 'w') as f:
+        f.write("[webservers]\nweb-1\n")
+    
+    assert count_inventory_hosts(inventory) == 2
+    assert count_inventory_hosts(script_inventory) == 1
+    assert count_inventory_hosts(ini_inventory) is None
+    assert count_inventory_hosts(os.path.join(tmp_path, 'missing.json')) is None
+
+def test_count_inventory_hosts_of_groups(tmp_path):
+    """Test counting only the hosts of the groups a playbook runs on."""
+    inventory = os.path.join(tmp_path, 'inventory.json')
+    with open(inventory, 'w') as f:
+        json.dump({'all': {'hosts': {'i-1': {}, 'i-2': {}, 'i-3': {}}, 'children': {
+            'webservers': {'hosts': {'i-1': {}, 'i-2': {}}},
+            'databases': {'hosts': {'i-2': {}, 'i-3': {}}}
+        }}}, f)
+    script_inventory = os.path.join(tmp_path, 'script.json')
+    with open(script_inventory, 'w') as f:
+        json.dump({'_meta': {'hostvars': {'i-1': {}, 'i-2': {}}},
+                   'webservers': {'hosts': ['i-1']}}, f)
+    
+    assert count_inventory_hosts(inventory, ['webservers']) == 2
+    assert count_inventory_hosts(inventory, ['webservers', 'databases']) == 3
+    assert count_inventory_hosts(inventory, ['missing']) == 0
+    assert count_inventory_hosts(script_inventory, ['webservers']) == 1
+
+def test_playbook_host_groups(tmp_path):
+    """Test reading the groups of a playbook's plays."""
+    playbook = os.path.join(tmp_path, 'site.yml')
+    with open(playbook, 'w') as f:
+        f.write("- hosts: webservers\n  tasks: []\n- hosts: db1:db2\n  tasks: []\n")
+    pattern_playbook = os.path.join(tmp_path, 'pattern.yml')
+    with open(pattern_playbook, 'w') as f:
+        f.write("- hosts: web*\n  tasks: []\n")
+    
+    assert playbook_host_groups(playbook) == ['webservers', 'db1', 'db2']
+    assert playbook_host_groups(pattern_playbook) is None
+    assert playbook_host_groups(os.path.join(tmp_path, 'missing.yml')) is None
+
+def test_execution_defaults_by_fleet_size():
+    """Test fleet-size-aware defaults of strategy, forks and serial."""
+    small = ExecutionOptions().with_defaults(3)
+    assert (small.strategy, small.forks, small.serial) == ('linear', 5, None)
+    
+    # Larger fleets keep linear; other strategies are only suggested
+    medium = ExecutionOptions().with_defaults(80)
+    assert (medium.strategy, medium.forks, medium.serial) == ('linear', 50, None)
+    
+    large = ExecutionOptions(throttle=10).with_defaults(500)
+    assert (large.strategy, large.forks, large.serial) == ('linear', 50, ['5%', '100%'])
+    assert large.throttle == 10
+    
+    subset = ExecutionOptions(gather_subset=['all']).with_defaults(500)
+    assert subset.gather_subset == ['all']
+    
+    explicit = ExecutionOptions('free', 200, [1, '100%']).with_defaults(500)
+    assert (explicit.strategy, explicit.forks, explicit.serial) == ('free', 200, [1, '100%'])
+    
+    assert ExecutionOptions().with_defaults(None) == ExecutionOptions()
+
+def test_run_playbook_execution_options(fake_runner):
+    """Test that execution options reach ansible-runner and the playbook."""
+    run = PlaybookRun('site.yml', 'dev.yml', extra_vars={'rollout_throttle': 2},
+                      execution=ExecutionOptions('free', 20, ['10%'], 5))
+    
+    run_playbook(run, on_event=None)
+    
+    kwargs = fake_runner.calls[0]
+    assert kwargs['forks'] == 20
+    assert kwargs['envvars'] == {'ANSIBLE_STRATEGY': 'free'}
+    # Explicit extra vars win over the execution options
+    assert kwargs['extravars'] == {'rollout_serial': ['10%'], 'rollout_throttle': 2}
+    
+    run = PlaybookRun('site.yml', 'dev.yml', execution=ExecutionOptions(gather_subset=['all']))
+    run_playbook(run, on_event=None,
+                 envvars={'ANSIBLE_GATHERING': 'smart', 'ANSIBLE_PIPELINING': 'True'})
+    assert fake_runner.calls[1]['extravars'] == {'facts_gather_subset': ['all']}
+    # Cached facts were gathered with the narrowed subsets
+    assert fake_runner.calls[1]['envvars'] == {
+        'ANSIBLE_GATHERING': 'implicit', 'ANSIBLE_PIPELINING': 'True'
+    }
+
+def test_run_playbook_fact_cache(fake_runner, tmp_path):
+    """Test that the fact cache directory is passed to ansible-runner, which overrides the envvar."""
+    cache_dir = os.path.join(tmp_path, 'facts')
+    envvars = {'ANSIBLE_CACHE_PLUGIN': 'jsonfile', 'ANSIBLE_CACHE_PLUGIN_CONNECTION': cache_dir}
+    
+    run_playbook(PlaybookRun('site.yml', 'dev.yml'), on_event=None, envvars=envvars)
+    run_playbook(PlaybookRun('site.yml', 'dev.yml'), on_event=None)
+    
+    assert fake_runner.calls[0]['fact_cache'] == cache_dir
+    assert fake_runner.calls[0]['fact_cache_type'] == 'jsonfile'
+    assert 'fact_cache' not in fake_runner.calls[1]
+
+def test_run_playbooks_concurrently(fake_runner):
+    """Test bounded concurrent runs with results in input order."""
+    runs = pair_runs(['site.yml'], ['dev.yml', 'broken.yml', 'qa.yml', 'prod.yml'])
+    events = []
+    
+    results = run_playbooks(runs, max_workers=2, on_event=events.append, forks=50)
+    
+    assert [result.run.inventory for result in results] == [
+        'dev.yml', 'broken.yml', 'qa.yml', 'prod.yml'
+    ]
+    assert [result.success for result in results] == [True, False, True, True]
+    assert results[1].failed_hosts == ['web-3']
+    assert fake_runner.max_active == 2
+    assert all(call['forks'] == 50 for call in fake_runner.calls)
+    assert HostEvent('site.yml@broken.yml', 'web-3', 'Install nginx', 'unreachable') in events
+
+def test_run_playbooks_reports_errors(fake_runner):
+    """Test that a run that can't start doesn't stop the others."""
+    original_run = fake_runner.run
+    
+    def run(**kwargs):
+        if 'qa' in kwargs['inventory']:
+            raise RuntimeError("ansible-playbook not found")
+        return original_run(**kwargs)
+    fake_runner.run = run
+    
+    results = run_playbooks(pair_runs(['site.yml'], ['dev.yml', 'qa.yml']), on_event=None)
+    
+    assert results[0].success is True
+    assert results[1].status == 'error'
+    assert "ansible-playbook not found" in results[1].error
+
+def test_run_playbooks_requires_ansible_runner():
+    """Test the error raised when ansible-runner is not installed."""
+    with patch.dict(sys.modules, {'ansible_runner': None}):
+        with pytest.raises(Exception) as exc_info:
+            run_playbooks([PlaybookRun('site.yml', 'dev.yml')])
+    
+    assert type(exc_info.value).__name__ == 'PlaybookError'
+
+def test_check_pipelining(fake_runner):
+    """Test classifying hosts whose sudo requires a tty."""
+    def run(**kwargs):
+        fake_runner.calls.append(kwargs)
+        for event in (
+            {'event': 'runner_on_ok', 'event_data': {'host': 'web-1', 'res': {}}},
+            {'event': 'runner_on_failed', 'event_data': {'host': 'web-2', 'res': {
+                'msg': 'MODULE FAILURE',
+                'module_stderr': 'sudo: sorry, you must have a tty to run sudo'}}},
+            {'event': 'runner_on_failed', 'event_data': {'host': 'web-3', 'res': {'msg': 'rc 1'}}},
+            {'event': 'runner_on_unreachable', 'event_data': {'host': 'web-4', 'res': {}}},
+        ):
+            kwargs['event_handler'](event)
+        return Mock(status='failed', rc=2, stats={})
+    fake_runner.run = run
+    
+    results = check_pipelining('hosts.json', {'ANSIBLE_PIPELINING': 'True'}, ['web-1'])
+    
+    assert results == {
+        'web-1': 'ok', 'web-2': 'requiretty', 'web-3': 'failed', 'web-4': 'unreachable'
+    }
+    kwargs = fake_runner.calls[0]
+    assert kwargs['cmdline'] == '--become'
+    assert kwargs['envvars'] == {'ANSIBLE_PIPELINING': 'True'}
+    assert kwargs['limit'] == 'web-1'
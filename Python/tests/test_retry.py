@@ -0,0 +1,81 @@
+"""
+Unit tests for AWS call retries and rate limiting.
+"""
+
+import pytest
+from unittest.mock import Mock, patch
+from botocore.exceptions import ClientError
+from python.src.utils.retry import TokenBucket, backoff_delay, call_with_retry
+
+def _client_error(code):
+    """Build a ClientError with the given error code."""
+    return ClientError({'Error': {'Code': code, 'Message': code}}, 'DescribeInstances')
+
+@pytest.fixture
+def no_sleep():
+    """Skip backoff delays."""
+    with patch('time.sleep') as mock_sleep:
+        yield mock_sleep
+
+def test_call_with_retry_success():
+    """Test that a successful call is made once."""
+    func = Mock(return_value='result')
+    
+    assert call_with_retry(func, 1, key='value') == 'result'
+    func.assert_called_once_with(1, key='value')
+
+def test_call_with_retry_throttled(no_sleep):
+    """Test that throttled calls are retried and slow down the limiter."""
+    func = Mock(side_effect=[_client_error('RequestLimitExceeded'), 'result'])
+    limiter = TokenBucket(rate=10)
+    
+    assert call_with_retry(func, limiter=limiter) == 'result'
+    assert func.call_count == 2
+    assert limiter.rate == 5.5
+    assert no_sleep.call_count >= 1
+
+def test_call_with_retry_gives_up(no_sleep):
+    """Test that retries stop after max_attempts."""
+    func = Mock(side_effect=_client_error('Throttling'))
+    
+    with pytest.raises(ClientError):
+        call_with_retry(func, max_attempts=3)
+    
+    assert func.call_count == 3
+
+def test_call_with_retry_non_retryable():
+    """Test that other errors are raised immediately."""
+    func = Mock(side_effect=_client_error('UnauthorizedOperation'))
+    
+    with pytest.raises(ClientError):
+        call_with_retry(func)
+    
+    func.assert_called_once()
+
+def test_backoff_delay_bounds():
+    """Test that backoff delays stay below the exponential cap."""
+    for attempt in range(1, 10):
+        assert 0 <= backoff_delay(attempt, 0.25, 5.0) <= min(5.0, 0.25 * 2 ** (attempt - 1))
+
+def test_token_bucket_rate_bounds():
+    """Test that the adaptive rate stays within its bounds."""
+    limiter = TokenBucket(rate=1, min_rate=0.5, max_rate=2, increase=1)
+    
+    limiter.on_throttle()
+    limiter.on_throttle()
+    assert limiter.rate == 0.5
+    
+    for _ in range(5):
+        limiter.on_success()
+    assert limiter.rate == 2
+
+def test_token_bucket_waits_when_empty(no_sleep):
+    """Test that acquire waits once the burst capacity is used."""
+    limiter = TokenBucket(rate=10, capacity=2)
+    
+    limiter.acquire()
+    limiter.acquire()
+    with patch('time.monotonic', side_effect=[limiter._updated, limiter._updated + 1]):
+        waited = limiter.acquire()
+    
+    assert waited > 0
@@ -2,11 +2,17 @@
 Unit tests for SSH key management.
 """
 
+import gc
 import os
+import time
+import weakref
+import subprocess
 import pytest
+from concurrent.futures import ThreadPoolExecutor
 from unittest.mock import patch, mock_open, Mock
-from python.src.utils.ssh_manager import SSHManager
+from python.src.utils.ssh_manager import SSHManager, public_key_fingerprint
 from python.src.utils.exceptions import SSHManagerError, ResourceNotFoundError
+from python.src.utils.metrics import current_span, span
 
 @pytest.fixture
 def ssh_manager(tmp_path):
@@ -111,4 +117,272 @@ def test_add_to_known_hosts_error(ssh_manager, mock_subprocess):
     with pytest.raises(Exception) as exc_info:
         ssh_manager.add_to_known_hosts('test-host')
     
-    assert str(exc_info.value) == "ssh-keyscan failed" 
\ No newline at end of file
+    assert str(exc_info.value) == "ssh-keyscan failed"
+
+@pytest.fixture
+def private_key(ssh_manager):
+    """Create an empty private key file."""
+    key_path = os.path.join(ssh_manager.key_dir, 'test-key')
+    with open(key_path, 'w') as f:
+        f.write('private key')
+    return key_path
+
+def test_verify_connectivity_batch(ssh_manager, private_key, mock_subprocess):
+    """Test verifying several hosts in one batch."""
+    def run(cmd, **kwargs):
+        result = Mock()
+        result.returncode = 0 if 'user@good-host' in cmd else 255
+        result.stderr = "Connection refused"
+        return result
+    mock_subprocess.side_effect = run
+    
+    results = ssh_manager.verify_connectivity_batch(
+        [('good-host', 'user'), ('bad-host', 'user')], 'test-key', max_workers=2
+    )
+    
+    assert results['good-host'].success is True
+    assert results['good-host'].error is None
+    assert results['good-host'].latency >= 0
+    assert results['bad-host'].success is False
+    assert results['bad-host'].error == "Connection refused"
+    assert mock_subprocess.call_count == 2
+
+def test_verify_connectivity_batch_nests_spans(ssh_manager, private_key, mock_subprocess):
+    """Test that checks run on the pool are recorded under the caller's span."""
+    parents = []
+    def run(cmd, **kwargs):
+        parents.append(current_span().parent.name)
+        return Mock(returncode=0, stderr="")
+    mock_subprocess.side_effect = run
+    
+    with span("deploy"):
+        ssh_manager.verify_connectivity_batch(
+            [('host-1', 'user'), ('host-2', 'user')], 'test-key', max_workers=2
+        )
+    
+    assert parents == ["deploy", "deploy"]
+
+def test_verify_connectivity_batch_deadline(ssh_manager, private_key, mock_subprocess):
+    """Test that no checks start once the batch deadline has passed."""
+    results = ssh_manager.verify_connectivity_batch(
+        [('host-1', 'user'), ('host-2', 'user')], 'test-key', deadline=0
+    )
+    
+    assert all(not result.success for result in results.values())
+    assert all(result.error == "deadline exceeded" for result in results.values())
+    mock_subprocess.assert_not_called()
+
+def test_verify_connectivity_batch_timeout(ssh_manager, private_key, mock_subprocess):
+    """Test that a host timeout is reported without failing the batch."""
+    mock_subprocess.side_effect = subprocess.TimeoutExpired('ssh', 1)
+    
+    results = ssh_manager.verify_connectivity_batch([('slow-host', 'user')], 'test-key')
+    
+    assert results['slow-host'].success is False
+    assert results['slow-host'].error == "timed out"
+
+def test_verify_connectivity_batch_missing_key(ssh_manager):
+    """Test verifying a batch with a missing private key."""
+    with pytest.raises(Exception) as exc_info:
+        ssh_manager.verify_connectivity_batch([('test-host', 'user')], 'missing-key')
+    
+    assert type(exc_info.value).__name__ == 'ResourceNotFoundError'
+
+@pytest.fixture
+def multiplexed_manager(tmp_path):
+    """Create SSHManager with ControlMaster multiplexing and a private key."""
+    manager = SSHManager(str(tmp_path), multiplex=True)
+    with open(os.path.join(tmp_path, 'test-key'), 'w') as f:
+        f.write('private key')
+    yield manager
+    manager._masters.clear()
+
+def test_multiplexed_verify_reuses_master(multiplexed_manager, mock_subprocess):
+    """Test that the master connection is opened once and then reused."""
+    mock_subprocess.return_value.returncode = 0
+    
+    assert multiplexed_manager.verify_connectivity('test-host', 'user', 'test-key') is True
+    assert multiplexed_manager.verify_connectivity('test-host', 'user', 'test-key') is True
+    
+    commands = [call.args[0] for call in mock_subprocess.call_args_list]
+    assert sum('ControlMaster=yes' in cmd for cmd in commands) == 1
+    assert sum('check' in cmd for cmd in commands) == 1
+    assert sum('ControlMaster=no' in cmd for cmd in commands) == 2
+    assert os.path.isdir(multiplexed_manager.control_dir)
+
+def test_multiplexed_verify_master_failure(multiplexed_manager, mock_subprocess):
+    """Test that a failed master connection fails the check."""
+    mock_subprocess.return_value.returncode = 255
+    
+    assert multiplexed_manager.verify_connectivity('test-host', 'user', 'test-key') is False
+    assert not multiplexed_manager._masters
+    mock_subprocess.assert_called_once()
+
+def test_close_masters(multiplexed_manager, mock_subprocess):
+    """Test that open master connections are stopped."""
+    mock_subprocess.return_value.returncode = 0
+    multiplexed_manager.verify_connectivity('test-host', 'user', 'test-key')
+    mock_subprocess.reset_mock()
+    
+    multiplexed_manager.close_masters()
+    
+    cmd = mock_subprocess.call_args.args[0]
+    assert cmd[:3] == ['ssh', '-O', 'exit']
+    assert 'user@test-host' in cmd
+    assert not multiplexed_manager._masters
+
+def test_multiplexed_verify_opens_one_master_per_host(multiplexed_manager, mock_subprocess):
+    """Test that concurrent checks of a host start a single master connection."""
+    def run(cmd, **kwargs):
+        if 'ControlMaster=yes' in cmd:
+            time.sleep(0.05)
+        return Mock(returncode=0)
+    mock_subprocess.side_effect = run
+    
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(
+            lambda _: multiplexed_manager.verify_connectivity('test-host', 'user', 'test-key'),
+            range(4)
+        ))
+    
+    commands = [call.args[0] for call in mock_subprocess.call_args_list]
+    assert sum('ControlMaster=yes' in cmd for cmd in commands) == 1
+    assert results == [True] * 4
+
+def test_manager_is_collected_with_multiplexing(tmp_path):
+    """Test that the exit cleanup doesn't keep a multiplexed manager alive."""
+    manager = SSHManager(str(tmp_path), multiplex=True)
+    reference = weakref.ref(manager)
+    
+    del manager
+    gc.collect()
+    
+    assert reference() is None
+
+def test_add_many_to_known_hosts(ssh_manager, mock_subprocess):
+    """Test scanning several hosts with one ssh-keyscan call."""
+    mock_subprocess.return_value.stdout = (
+        "web-1 ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n"
+        "web-2 ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n"
+    )
+    
+    results = ssh_manager.add_many_to_known_hosts(['web-1', 'web-2', 'web-3'])
+    
+    assert results == {'web-1': True, 'web-2': True, 'web-3': False}
+    mock_subprocess.assert_called_once()
+    assert mock_subprocess.call_args.args[0][-3:] == ['web-1', 'web-2', 'web-3']
+
+def test_add_many_to_known_hosts_batches(ssh_manager, mock_subprocess):
+    """Test that large host lists are split across ssh-keyscan calls."""
+    mock_subprocess.return_value.stdout = ""
+    
+    ssh_manager.add_many_to_known_hosts([f"web-{i}" for i in range(5)], batch_size=2)
+    
+    assert mock_subprocess.call_count == 3
+
+def test_add_many_to_known_hosts_reports_keyscan_errors(ssh_manager, mock_subprocess):
+    """Test that a failing ssh-keyscan batch is logged and its hosts reported unscanned."""
+    mock_subprocess.return_value = Mock(
+        returncode=1,
+        stdout="web-1 ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n",
+        stderr="getaddrinfo web-2: Name or service not known\n"
+    )
+    
+    with patch('python.src.utils.ssh_manager.logger') as mock_logger:
+        results = ssh_manager.add_many_to_known_hosts(['web-1', 'web-2'])
+    
+    assert results == {'web-1': True, 'web-2': False}
+    message = mock_logger.warning.call_args.args[0]
+    assert "status 1" in message
+    assert "getaddrinfo web-2" in message
+
+def test_add_to_known_hosts_twice(ssh_manager, mock_subprocess):
+    """Test that adding a host twice keeps a single entry."""
+    mock_subprocess.return_value.stdout = "test-host ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n"
+    
+    ssh_manager.add_to_known_hosts('test-host')
+    ssh_manager.add_to_known_hosts('test-host')
+    
+    with open(os.path.join(ssh_manager.key_dir, 'known_hosts')) as f:
+        assert f.read() == "test-host ssh-ed25519 AAAAC3NzaC1lZDI1NTE5\n"
+
+ED25519_PUBLIC_KEY = (
+    "ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAIGZ6jb+3zkSSfD8xQHTxuw3cMsh3aXmjULaOiEtI1CxY test@example.com"
+)
+
+@pytest.fixture
+def key_pair(ssh_manager):
+    """Create a key pair in the key directory."""
+    private_key_path = os.path.join(ssh_manager.key_dir, 'indexed_key')
+    with open(private_key_path, 'w') as f:
+        f.write('private key')
+    with open(f"{private_key_path}.pub", 'w') as f:
+        f.write(f"{ED25519_PUBLIC_KEY}\n")
+    return private_key_path
+
+def test_public_key_fingerprint():
+    """Test that fingerprints match ssh-keygen -l output."""
+    # ssh-keygen -lf of ED25519_PUBLIC_KEY
+    assert public_key_fingerprint(ED25519_PUBLIC_KEY) == (
+        "SHA256:sHm7nwanwmcsrkkYAkp9pacY52tmHwo/IVu+21/8Zrg"
+    )
+    assert public_key_fingerprint("not a key") is None
+
+def test_list_keys(ssh_manager, key_pair):
+    """Test listing every managed key with its fingerprint."""
+    keys = ssh_manager.list_keys()
+    
+    assert list(keys) == ['indexed_key']
+    assert keys['indexed_key'].public_key == ED25519_PUBLIC_KEY
+    assert keys['indexed_key'].fingerprint == public_key_fingerprint(ED25519_PUBLIC_KEY)
+    assert keys['indexed_key'].private_key_path == key_pair
+
+def test_get_public_key_cached(ssh_manager, key_pair):
+    """Test that indexed public keys are not re-read from disk."""
+    ssh_manager.list_keys()
+    
+    with patch('builtins.open', side_effect=AssertionError("public key re-read")):
+        assert ssh_manager.get_public_key('indexed_key') == ED25519_PUBLIC_KEY
+
+def test_get_public_key_reloads_modified_key(ssh_manager, key_pair):
+    """Test that a rewritten public key invalidates the cached entry."""
+    ssh_manager.get_public_key('indexed_key')
+    
+    with open(f"{key_pair}.pub", 'w') as f:
+        f.write("ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAIRotated\n")
+    stat = os.stat(f"{key_pair}.pub")
+    os.utime(f"{key_pair}.pub", ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000))
+    
+    assert ssh_manager.get_public_key('indexed_key') == "ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAIRotated"
+
+def test_list_keys_sees_new_keys(ssh_manager, key_pair):
+    """Test that keys added after the first scan are indexed."""
+    assert len(ssh_manager.list_keys()) == 1
+    
+    with open(os.path.join(ssh_manager.key_dir, 'second_key.pub'), 'w') as f:
+        f.write(f"{ED25519_PUBLIC_KEY}\n")
+    
+    assert sorted(ssh_manager.list_keys()) == ['indexed_key', 'second_key']
+
+def test_list_keys_sees_keys_added_in_the_same_tick(ssh_manager, key_pair):
+    """Test that a key added without a directory mtime change is indexed."""
+    mtime = os.stat(ssh_manager.key_dir).st_mtime_ns
+    assert len(ssh_manager.list_keys()) == 1
+    
+    with open(os.path.join(ssh_manager.key_dir, 'second_key.pub'), 'w') as f:
+        f.write(f"{ED25519_PUBLIC_KEY}\n")
+    # A filesystem with coarse timestamps keeps the previous mtime
+    os.utime(ssh_manager.key_dir, ns=(mtime, mtime))
+    
+    assert sorted(ssh_manager.list_keys()) == ['indexed_key', 'second_key']
+
+def test_generate_key_pair_existing_after_indexing(ssh_manager, key_pair, mock_subprocess):
+    """Test that a key created after the last scan is not generated again."""
+    ssh_manager.list_keys()
+    with open(os.path.join(ssh_manager.key_dir, 'new_key'), 'w') as f:
+        f.write('private key')
+    
+    with patch.object(ssh_manager, '_refresh_key_index'):
+        ssh_manager.generate_key_pair('new_key')
+    
+    mock_subprocess.assert_not_called()
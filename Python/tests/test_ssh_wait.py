@@ -0,0 +1,150 @@
+"""
+Unit tests for SSH readiness polling.
+"""
+
+import os
+import asyncio
+import pytest
+from unittest.mock import AsyncMock, Mock, patch
+from python.src.utils import ssh_wait
+from python.src.utils.metrics import current_span, span
+from python.src.utils.ssh_manager import SSHManager
+
+async def _start_server(banner):
+    """Start a local TCP server that sends a banner to each client."""
+    async def handle(reader, writer):
+        writer.write(banner)
+        await writer.drain()
+        writer.close()
+    server = await asyncio.start_server(handle, '127.0.0.1', 0)
+    return server, server.sockets[0].getsockname()[1]
+
+def test_probe_ssh_port_banner():
+    """Test that a server sending an SSH banner is detected."""
+    async def probe():
+        server, port = await _start_server(b"SSH-2.0-OpenSSH_9.6\r\n")
+        async with server:
+            return await ssh_wait.probe_ssh_port('127.0.0.1', port, timeout=1)
+    
+    assert asyncio.run(probe()) is True
+
+def test_probe_ssh_port_not_ssh():
+    """Test that an open port without an SSH banner is not ready."""
+    async def probe():
+        server, port = await _start_server(b"HTTP/1.1 400 Bad Request\r\n")
+        async with server:
+            return await ssh_wait.probe_ssh_port('127.0.0.1', port, timeout=1)
+    
+    assert asyncio.run(probe()) is False
+
+def test_probe_ssh_port_waits_for_close():
+    """Test that the connection is closed before returning, even if closing fails."""
+    reader = Mock()
+    reader.readline = AsyncMock(return_value=b"SSH-2.0-OpenSSH_9.6\r\n")
+    writer = Mock()
+    writer.wait_closed = AsyncMock(side_effect=ConnectionResetError("reset by peer"))
+    
+    with patch('asyncio.open_connection', AsyncMock(return_value=(reader, writer))):
+        assert asyncio.run(ssh_wait.probe_ssh_port('127.0.0.1', timeout=1)) is True
+    
+    writer.close.assert_called_once()
+    writer.wait_closed.assert_awaited_once()
+
+def test_probe_ssh_port_closed():
+    """Test that a closed port is not ready."""
+    async def probe():
+        server, port = await _start_server(b"")
+        server.close()
+        await server.wait_closed()
+        return await ssh_wait.probe_ssh_port('127.0.0.1', port, timeout=1)
+    
+    assert asyncio.run(probe()) is False
+
+@pytest.fixture
+def no_delay():
+    """Poll without waiting between probes."""
+    with patch.object(ssh_wait, 'MIN_POLL_INTERVAL', 0), \
+            patch.object(ssh_wait, 'backoff_delay', return_value=0):
+        yield
+
+def test_wait_until_ready_escalates_after_probe(no_delay):
+    """Test that the handshake only runs once the port answers."""
+    probe = Mock(side_effect=[False, False, True])
+    check = Mock(return_value=(True, None))
+    
+    async def fake_probe(host, port, timeout):
+        return probe()
+    
+    with patch.object(ssh_wait, 'probe_ssh_port', fake_probe):
+        results = asyncio.run(ssh_wait.wait_until_ready([('web-1', 'ubuntu')], check, timeout=5))
+    
+    assert results['web-1'].ready is True
+    assert results['web-1'].probes == 3
+    assert results['web-1'].elapsed >= 0
+    check.assert_called_once()
+    assert check.call_args.args[:2] == ('web-1', 'ubuntu')
+
+def test_wait_until_ready_retries_handshake(no_delay):
+    """Test that a failed handshake is retried with the next probe."""
+    check = Mock(side_effect=[(False, "Permission denied"), (True, None)])
+    
+    async def fake_probe(host, port, timeout):
+        return True
+    
+    with patch.object(ssh_wait, 'probe_ssh_port', fake_probe):
+        results = asyncio.run(ssh_wait.wait_until_ready([('web-1', 'ubuntu')], check, timeout=5))
+    
+    assert results['web-1'].ready is True
+    assert check.call_count == 2
+
+def test_wait_until_ready_nests_spans(no_delay):
+    """Test that handshakes run on the executor are recorded under the caller's span."""
+    parents = []
+    def check(host, user, timeout):
+        parents.append(current_span().name)
+        return True, None
+    
+    async def fake_probe(host, port, timeout):
+        return True
+    
+    async def wait():
+        with span("deploy"):
+            return await ssh_wait.wait_until_ready([('web-1', 'ubuntu')], check, timeout=5)
+    
+    with patch.object(ssh_wait, 'probe_ssh_port', fake_probe):
+        asyncio.run(wait())
+    
+    assert parents == ["deploy"]
+
+def test_wait_until_ready_timeout():
+    """Test that hosts that never answer are reported with the last error."""
+    async def fake_probe(host, port, timeout):
+        return False
+    
+    with patch.object(ssh_wait, 'probe_ssh_port', fake_probe):
+        results = asyncio.run(
+            ssh_wait.wait_until_ready([('web-1', 'ubuntu')], Mock(), timeout=0.2)
+        )
+    
+    assert results['web-1'].ready is False
+    assert results['web-1'].error == "SSH port not open"
+    assert results['web-1'].probes >= 1
+
+def test_ssh_manager_wait_for_ssh(tmp_path):
+    """Test waiting for hosts through SSHManager."""
+    manager = SSHManager(str(tmp_path))
+    with open(os.path.join(tmp_path, 'test-key'), 'w') as f:
+        f.write('private key')
+    
+    async def open_connection(host, port):
+        reader = asyncio.StreamReader()
+        reader.feed_data(b"SSH-2.0-OpenSSH_9.6\r\n")
+        return reader, Mock(wait_closed=AsyncMock())
+    
+    with patch('asyncio.open_connection', open_connection), \
+            patch('subprocess.run') as mock_run:
+        mock_run.return_value.returncode = 0
+        results = manager.wait_for_ssh([('web-1', 'ubuntu'), ('web-2', 'ubuntu')], 'test-key')
+    
+    assert all(result.ready for result in results.values())
+    assert mock_run.call_count == 2